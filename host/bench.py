@@ -0,0 +1,169 @@
+#!/usr/bin/env python
+#
+# Runs every test_unit.c scene through a full hour of the host build on the virtual
+# clock and compares the cost of each hour against stored baselines.
+#
+#   bench.py <floatyduck_host> [--update] [--threshold PERCENT]
+#
+# Each scene starts five minutes before its hour and runs to five minutes past, the
+# same window test_unit.c steps through. The scene dates are read from the constants
+# in test_unit.c so both stay in step. Every scene is run again at the battery charge of
+# each battery saver tier below full, as <scene>-saving and <scene>-low.
+#
+
+import argparse
+import os
+import re
+import subprocess
+import sys
+
+ROOT = os.path.dirname(os.path.dirname(os.path.abspath(__file__)))
+TEST_UNIT = os.path.join(ROOT, 'src', 'test_unit.c')
+BASELINE = os.path.join(ROOT, 'host', 'bench_baseline.txt')
+
+# (scene, test_unit.c date constant, taps in seconds after start)
+SCENES = [
+    ('friday13', 'FEB_13_2015_00_00_00', [450, 1800, 3330]),
+    ('valentines', 'FEB_14_2015_00_00_00', [450, 1800, 3330]),
+    ('christmas', 'DEC_25_2014_00_00_00', [450, 1800, 3330]),
+    ('thanksgiving', 'NOV_27_2014_00_00_00', [450, 1800, 3330]),
+    ('normal', 'JAN_01_2015_00_00_00', [450, 1800, 3330]),
+]
+
+# (name suffix, battery percent) of each battery saver tier, see PowerTier in common.h.
+POWER_TIERS = [
+    ('', 80),
+    ('-saving', 25),
+    ('-low', 5),
+]
+
+SCENE_LEAD_SECONDS = 5 * 60
+SCENE_DURATION_SECONDS = 70 * 60
+
+# Metrics that are deterministic on the virtual clock and gated by the threshold.
+GATED_METRICS = [
+    'wakeups',
+    'frames_rendered',
+    'animations_scheduled',
+    'timers_registered',
+    'bitmaps_decoded',
+    'heap_peak',
+    'pixel_ops',
+    'dirty_pixels',
+]
+
+# Metrics that must be zero whatever the baseline says. Minute ticks run on the heap the
+# layers already hold, see tick_app_allocs in host.h.
+ZERO_METRICS = ['tick_app_allocs']
+
+# Wakeups scaled to one hour of the scene, so scenes of any length compare directly.
+DERIVED_METRICS = ['wakeups_per_hour']
+
+# Host CPU time depends on the machine, so it is reported but only gated on request.
+CPU_METRIC = 'cpu_ms'
+
+
+def read_scene_dates():
+    dates = {}
+    with open(TEST_UNIT) as source:
+        for match in re.finditer(r'#define\s+(\w+_00_00_00)\s+(\d+)', source.read()):
+            dates[match.group(1)] = int(match.group(2))
+
+    return dates
+
+
+def run_scene(binary, start, taps, battery):
+    env = dict(os.environ)
+    env['HOST_START'] = str(start - SCENE_LEAD_SECONDS)
+    env['HOST_DURATION'] = str(SCENE_DURATION_SECONDS)
+    env['HOST_TAPS'] = ','.join(str(tap) for tap in taps)
+    env['HOST_BATTERY'] = str(battery)
+    env.pop('HOST_CHARGING', None)
+    env.pop('HOST_LOG', None)
+    env.pop('HOST_FRAMEBUFFER', None)
+
+    output = subprocess.check_output([binary], env=env, universal_newlines=True)
+    metrics = {}
+    for line in output.splitlines():
+        key, _, value = line.partition('=')
+        if value:
+            metrics[key] = int(value)
+
+    cpu_ns = metrics['startup_cpu_ns'] + metrics['callback_cpu_ns'] + metrics['render_cpu_ns']
+    metrics[CPU_METRIC] = cpu_ns // 1000000
+    metrics['wakeups_per_hour'] = metrics['wakeups'] * 3600 // SCENE_DURATION_SECONDS
+    return metrics
+
+
+def read_baseline():
+    baseline = {}
+    if os.path.exists(BASELINE):
+        with open(BASELINE) as lines:
+            for line in lines:
+                fields = line.split()
+                if len(fields) == 3 and not line.startswith('#'):
+                    baseline[(fields[0], fields[1])] = int(fields[2])
+
+    return baseline
+
+
+def write_baseline(results):
+    with open(BASELINE, 'w') as out:
+        out.write('# scene metric value - regenerate with host/bench.py <binary> --update\n')
+        for scene, metrics in results:
+            for metric in GATED_METRICS + DERIVED_METRICS + [CPU_METRIC]:
+                out.write('%s %s %d\n' % (scene, metric, metrics[metric]))
+
+
+def main():
+    parser = argparse.ArgumentParser(description='Per-scene hour benchmark for the host build.')
+    parser.add_argument('binary', help='path to floatyduck_host')
+    parser.add_argument('--update', action='store_true', help='store the results as the new baselines')
+    parser.add_argument('--threshold', type=float, default=5.0,
+                        help='allowed increase over baseline in percent (default 5)')
+    parser.add_argument('--cpu-threshold', type=float, default=None,
+                        help='also gate host CPU time with this allowed increase in percent')
+    args = parser.parse_args()
+
+    dates = read_scene_dates()
+    results = []
+    for suffix, battery in POWER_TIERS:
+        for scene, constant, taps in SCENES:
+            results.append((scene + suffix, run_scene(args.binary, dates[constant], taps, battery)))
+
+    if args.update:
+        write_baseline(results)
+        print('Baselines written to %s' % os.path.relpath(BASELINE, ROOT))
+        return 0
+
+    baseline = read_baseline()
+    failed = False
+    print('%-19s %-21s %12s %12s %8s' % ('scene', 'metric', 'baseline', 'current', 'change'))
+    for scene, metrics in results:
+        for metric in GATED_METRICS + DERIVED_METRICS + [CPU_METRIC]:
+            current = metrics[metric]
+            expected = baseline.get((scene, metric))
+            if expected is None:
+                print('%-19s %-21s %12s %12d %8s' % (scene, metric, '-', current, 'new'))
+                continue
+
+            change = ((current - expected) * 100.0 / expected) if expected else (100.0 if current else 0.0)
+            threshold = args.threshold if metric != CPU_METRIC else args.cpu_threshold
+            status = ''
+            if threshold is not None and change > threshold:
+                status = ' FAIL'
+                failed = True
+
+            print('%-19s %-21s %12d %12d %+7.1f%%%s' % (scene, metric, expected, current, change, status))
+
+        for metric in ZERO_METRICS:
+            if metrics[metric] != 0:
+                print('%-19s %-21s %12s %12d %8s' % (scene, metric, '0', metrics[metric], 'FAIL'))
+                failed = True
+
+    print('FAIL' if failed else 'PASS')
+    return 1 if failed else 0
+
+
+if __name__ == '__main__':
+    sys.exit(main())
@@ -0,0 +1,159 @@
+#define HOST_RUNTIME
+#include "host.h"
+#include "sprite_blit.h"
+
+// Draws the shark and santa at every alignment to a screen word, with the sprite blitter
+// and with graphics_draw_bitmap_in_rect in GCompOpAnd, and reports how many sprites each
+// draws per millisecond of host CPU time.
+//
+//   blit_bench
+//
+// Both draw over the same noise and must leave the same pixels, at every alignment and
+// clipped off each edge of the screen, or the run fails.
+
+#define BLIT_ITERATIONS 5000
+#define GRAPHICS_ITERATIONS 200
+#define ALIGNMENTS 32
+#define COUNT_OF(array) (sizeof(array) / sizeof((array)[0]))
+
+typedef struct {
+  const char *name;
+  uint32_t resourceId;
+  GRect subRect;        // Part of the image drawn, all of it if empty
+} Sprite;
+
+static const Sprite _sprites[] = {
+  { "santa", RESOURCE_ID_IMAGE_SANTA, { { 0, 0 }, { 0, 0 } } },
+  { "shark", RESOURCE_ID_IMAGE_SHARK, { { 0, 0 }, { 0, 0 } } },
+  { "shark eat frame", RESOURCE_ID_IMAGE_SHARK_EAT_STRIP, { { 3, 40 }, { 70, 20 } } },
+};
+
+// Offsets from the aligned x and y that put the sprite on screen and off each edge.
+static const int16_t _offsetsX[] = { -160, -64, -32, 0, 32, 96, 128 };
+static const int16_t _offsetsY[] = { -20, 0, 60, 150 };
+
+static uint8_t *_noise;
+static size_t _framebufferSize;
+
+static void fillNoise(uint8_t *data, size_t size);
+static void drawGraphics(const GBitmap *sprite, GPoint origin);
+static bool blitMatches(const GBitmap *sprite, GPoint origin, uint8_t *expected);
+static double spritesPerMs(const GBitmap *sprite, GPoint origin, bool blit);
+
+int main(int argc, char **argv) {
+  if (argc != 1) {
+    fprintf(stderr, "usage: %s\n", argv[0]);
+    return 2;
+  }
+
+  GBitmap *framebuffer = HostFramebuffer();
+  _framebufferSize = framebuffer->row_size_bytes * HOST_SCREEN_HEIGHT;
+  _noise = malloc(_framebufferSize);
+  uint8_t *expected = malloc(_framebufferSize);
+  fillNoise(_noise, _framebufferSize);
+  uint32_t mismatches = 0;
+
+  printf("%-16s %5s %10s %12s %8s\n", "sprite", "align", "blit/ms", "graphics/ms", "speedup");
+
+  for (size_t index = 0; index < COUNT_OF(_sprites); index++) {
+    const Sprite *entry = &_sprites[index];
+    GBitmap *image = gbitmap_create_with_resource(entry->resourceId);
+    GBitmap *sprite = image;
+    if (image != NULL && entry->subRect.size.w > 0) {
+      sprite = gbitmap_create_as_sub_bitmap(image, entry->subRect);
+    }
+
+    if (sprite == NULL) {
+      fprintf(stderr, "%s: failed to load\n", entry->name);
+      mismatches++;
+      continue;
+    }
+
+    for (int16_t alignment = 0; alignment < ALIGNMENTS; alignment++) {
+      for (size_t x = 0; x < COUNT_OF(_offsetsX); x++) {
+        for (size_t y = 0; y < COUNT_OF(_offsetsY); y++) {
+          GPoint origin = GPoint(alignment + _offsetsX[x], _offsetsY[y]);
+          if (blitMatches(sprite, origin, expected) == false) {
+            if (mismatches == 0) {
+              fprintf(stderr, "%s at %d, %d differs from graphics_draw_bitmap_in_rect\n",
+                      entry->name, origin.x, origin.y);
+            }
+
+            mismatches++;
+          }
+        }
+      }
+
+      // Timed on screen at the alignment, clipped on the right if it is too wide.
+      if (image == sprite) {
+        GPoint origin = GPoint(alignment, 60);
+        double blit = spritesPerMs(sprite, origin, true);
+        double graphics = spritesPerMs(sprite, origin, false);
+        printf("%-16s %5d %10.1f %12.1f %7.1fx\n", entry->name, alignment, blit, graphics,
+               (graphics > 0) ? blit / graphics : 0);
+      }
+    }
+
+    if (sprite != image) {
+      gbitmap_destroy(sprite);
+    }
+
+    gbitmap_destroy(image);
+  }
+
+  if (mismatches > 0) {
+    printf("FAIL: %u blits differ\n", mismatches);
+  }
+
+  free(expected);
+  free(_noise);
+  return (mismatches > 0) ? 1 : 0;
+}
+
+// A fixed pseudo-random pattern, so that both ways of drawing have black and white to
+// AND over.
+static void fillNoise(uint8_t *data, size_t size) {
+  uint32_t state = 0x2545f491;
+  for (size_t index = 0; index < size; index++) {
+    state = state * 1103515245 + 12345;
+    data[index] = (uint8_t) (state >> 16);
+  }
+}
+
+static void drawGraphics(const GBitmap *sprite, GPoint origin) {
+  GContext *ctx = HostGraphicsContext();
+  HostContextReset(ctx);
+  graphics_context_set_compositing_mode(ctx, GCompOpAnd);
+  graphics_draw_bitmap_in_rect(ctx, sprite, (GRect) { .origin = origin, .size = sprite->bounds.size });
+}
+
+static bool blitMatches(const GBitmap *sprite, GPoint origin, uint8_t *expected) {
+  GBitmap *framebuffer = HostFramebuffer();
+
+  memcpy(framebuffer->addr, _noise, _framebufferSize);
+  drawGraphics(sprite, origin);
+  memcpy(expected, framebuffer->addr, _framebufferSize);
+
+  memcpy(framebuffer->addr, _noise, _framebufferSize);
+  BlitSpriteAnd(framebuffer, sprite, origin);
+  return (memcmp(expected, framebuffer->addr, _framebufferSize) == 0);
+}
+
+static double spritesPerMs(const GBitmap *sprite, GPoint origin, bool blit) {
+  GBitmap *framebuffer = HostFramebuffer();
+  int iterations = blit ? BLIT_ITERATIONS : GRAPHICS_ITERATIONS;
+  memcpy(framebuffer->addr, _noise, _framebufferSize);
+
+  uint64_t start = HostCpuNs();
+  for (int iteration = 0; iteration < iterations; iteration++) {
+    if (blit) {
+      BlitSpriteAnd(framebuffer, sprite, origin);
+
+    } else {
+      drawGraphics(sprite, origin);
+    }
+  }
+
+  uint64_t elapsedNs = HostCpuNs() - start;
+  return (elapsedNs > 0) ? iterations * 1000000.0 / elapsedNs : 0;
+}
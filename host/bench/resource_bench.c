@@ -0,0 +1,161 @@
+#define HOST_RUNTIME
+#include "host.h"
+
+// Loads every image in appinfo.json, both from its PNG file and from the packed form the
+// build embeds, and reports what each load costs in host CPU time and app heap.
+//
+//   resource_bench <resources dir> [budget bytes]
+//
+// Resident bytes stay allocated while the bitmap is held; transient bytes are the extra
+// the loader needs at its peak and gives back before it returns. A load whose peak is
+// over the budget is flagged, and a packed load over it, which is what the watch pays,
+// fails the run.
+
+// A third of the 24 KB app heap on aplite, the smallest platform.
+#define DEFAULT_LOAD_BUDGET 8192
+
+#define LOAD_ITERATIONS 200
+
+typedef GBitmap* (*BitmapLoader)(const uint8_t *data, uint32_t size);
+
+typedef struct {
+  uint64_t loadNs;        // Average over LOAD_ITERATIONS loads
+  size_t residentBytes;
+  size_t peakBytes;
+} LoadCost;
+
+static uint8_t* readFile(const char *directory, const char *file, uint32_t *size);
+static GBitmap* measureLoad(BitmapLoader loader, const uint8_t *data, uint32_t size, LoadCost *cost);
+static bool samePixels(const GBitmap *a, const GBitmap *b);
+static bool printCost(const char *name, const char *form, uint32_t size, const LoadCost *cost, size_t budget);
+
+int main(int argc, char **argv) {
+  if (argc < 2 || argc > 3) {
+    fprintf(stderr, "usage: %s <resources dir> [budget bytes]\n", argv[0]);
+    return 2;
+  }
+
+  size_t budget = (argc == 3) ? strtoul(argv[2], NULL, 10) : DEFAULT_LOAD_BUDGET;
+  bool packedOverBudget = false;
+  bool failed = false;
+
+  printf("%-28s %-6s %8s %10s %9s %10s %6s\n",
+         "resource", "form", "bytes", "load_us", "resident", "transient", "");
+
+  for (uint32_t resourceId = 1; resourceId < HostResourceCount; resourceId++) {
+    const HostResource *resource = HostGetResource(resourceId);
+    uint32_t pngSize = 0;
+    uint8_t *png = readFile(argv[1], resource->file, &pngSize);
+    if (png == NULL) {
+      fprintf(stderr, "%s: cannot read %s\n", resource->name, resource->file);
+      failed = true;
+      continue;
+    }
+
+    LoadCost pngCost, packedCost;
+    GBitmap *fromPng = measureLoad(HostDecodePng, png, pngSize, &pngCost);
+    GBitmap *fromPacked = measureLoad(HostLoadPackedBitmap, resource->data, resource->size, &packedCost);
+
+    if (fromPng == NULL || fromPacked == NULL) {
+      fprintf(stderr, "%s: failed to load\n", resource->name);
+      failed = true;
+
+    } else if (!samePixels(fromPng, fromPacked)) {
+      fprintf(stderr, "%s: packed pixels differ from the PNG\n", resource->name);
+      failed = true;
+
+    } else {
+      printCost(resource->name, "png", pngSize, &pngCost, budget);
+      if (printCost(resource->name, "packed", resource->size, &packedCost, budget)) {
+        packedOverBudget = true;
+      }
+    }
+
+    gbitmap_destroy(fromPng);
+    gbitmap_destroy(fromPacked);
+    free(png);
+  }
+
+  if (packedOverBudget) {
+    printf("FAIL: a packed load needs more than %zu bytes of heap\n", budget);
+  }
+
+  return (failed || packedOverBudget) ? 1 : 0;
+}
+
+static uint8_t* readFile(const char *directory, const char *file, uint32_t *size) {
+  char path[512];
+  snprintf(path, sizeof(path), "%s/%s", directory, file);
+
+  FILE *in = fopen(path, "rb");
+  if (in == NULL) {
+    return NULL;
+  }
+
+  fseek(in, 0, SEEK_END);
+  long length = ftell(in);
+  fseek(in, 0, SEEK_SET);
+
+  uint8_t *data = (length > 0) ? malloc(length) : NULL;
+  if (data != NULL && fread(data, 1, length, in) != (size_t) length) {
+    free(data);
+    data = NULL;
+  }
+
+  fclose(in);
+  *size = (uint32_t) length;
+  return data;
+}
+
+// Returns the bitmap from the first load, which is the one the heap figures are taken
+// from. The timed loads after it are destroyed straight away.
+static GBitmap* measureLoad(BitmapLoader loader, const uint8_t *data, uint32_t size, LoadCost *cost) {
+  HostMetrics *metrics = HostGetMetrics();
+  size_t heapBefore = metrics->heapCurrent;
+  metrics->heapPeak = heapBefore;
+
+  GBitmap *bitmap = loader(data, size);
+  if (bitmap == NULL) {
+    return NULL;
+  }
+
+  cost->residentBytes = metrics->heapCurrent - heapBefore;
+  cost->peakBytes = metrics->heapPeak - heapBefore;
+
+  uint64_t start = HostCpuNs();
+  for (int i = 0; i < LOAD_ITERATIONS; i++) {
+    gbitmap_destroy(loader(data, size));
+  }
+
+  cost->loadNs = (HostCpuNs() - start) / LOAD_ITERATIONS;
+  return bitmap;
+}
+
+static bool samePixels(const GBitmap *a, const GBitmap *b) {
+  if (a->bounds.size.w != b->bounds.size.w || a->bounds.size.h != b->bounds.size.h ||
+      a->row_size_bytes != b->row_size_bytes) {
+    return false;
+  }
+
+  // Padding bits past the last column are not compared.
+  for (int16_t y = 0; y < a->bounds.size.h; y++) {
+    const uint8_t *rowA = (const uint8_t*) a->addr + y * a->row_size_bytes;
+    const uint8_t *rowB = (const uint8_t*) b->addr + y * b->row_size_bytes;
+
+    for (int16_t x = 0; x < a->bounds.size.w; x++) {
+      if (((rowA[x / 8] ^ rowB[x / 8]) >> (x % 8)) & 1) {
+        return false;
+      }
+    }
+  }
+
+  return true;
+}
+
+// Prints one row of the report and returns true if the load was over the budget.
+static bool printCost(const char *name, const char *form, uint32_t size, const LoadCost *cost, size_t budget) {
+  bool overBudget = cost->peakBytes > budget;
+  printf("%-28s %-6s %8u %10.1f %9zu %10zu %6s\n", name, form, size, cost->loadNs / 1000.0,
+         cost->residentBytes, cost->peakBytes - cost->residentBytes, overBudget ? "OVER" : "");
+  return overBudget;
+}
\ No newline at end of file
@@ -0,0 +1,102 @@
+#define HOST_RUNTIME
+#include "host.h"
+#include "rotation_cache.h"
+#include "bitmap_cache.h"
+
+// Turns each duck pose through a full circle in 5 degree steps, the way the duck's move
+// animation turns it, and reports the heap allocations and host CPU time per step.
+//
+//   rotation_bench
+//
+// After the first step every angle is rendered over the rendering it replaces, so any
+// allocation while turning fails the run. So does a rendering that differs from the same
+// angle rendered into a fresh cache.
+
+#define ANGLE_STEP 5
+#define COUNT_OF(array) (sizeof(array) / sizeof((array)[0]))
+
+typedef struct {
+  const char *name;
+  uint32_t resourceId;
+} Pose;
+
+static const Pose _poses[] = {
+  { "duck", RESOURCE_ID_IMAGE_DUCK },
+  { "duck left", RESOURCE_ID_IMAGE_DUCK_LEFT },
+  { "duck dive", RESOURCE_ID_IMAGE_DUCK_DIVE },
+  { "taking off", RESOURCE_ID_IMAGE_DUCK_TAKING_OFF },
+  { "landing", RESOURCE_ID_IMAGE_DUCK_LANDING },
+};
+
+static uint32_t heapAllocs(void);
+static bool renderingMatches(uint32_t resourceId, int32_t angle, const GBitmap *rendering);
+
+int main(int argc, char **argv) {
+  if (argc != 1) {
+    fprintf(stderr, "usage: %s\n", argv[0]);
+    return 2;
+  }
+
+  RotBitmapGroup group;
+  memset(&group, 0, sizeof(RotBitmapGroup));
+  group.layer = bitmap_layer_create(GRect(0, 0, 0, 0));
+
+  uint32_t failures = 0;
+  printf("%-12s %6s %8s %10s\n", "pose", "steps", "allocs", "step_us");
+
+  for (size_t index = 0; index < COUNT_OF(_poses); index++) {
+    const Pose *pose = &_poses[index];
+    RotBitmapGroupChangeBitmap(&group, pose->resourceId);
+    RotBitmapGroupSetAngle(&group, ANGLE_STEP);
+
+    uint32_t steps = 0;
+    uint32_t allocs = heapAllocs();
+    uint64_t start = HostCpuNs();
+    for (int32_t angle = 2 * ANGLE_STEP; angle < 360 + ANGLE_STEP; angle += ANGLE_STEP) {
+      RotBitmapGroupSetAngle(&group, angle % 360);
+      steps++;
+    }
+
+    uint64_t stepNs = (HostCpuNs() - start) / steps;
+    allocs = heapAllocs() - allocs;
+    printf("%-12s %6u %8u %10.2f\n", pose->name, steps, allocs, stepNs / 1000.0);
+
+    if (allocs > 0) {
+      printf("FAIL: %s allocates while turning\n", pose->name);
+      failures++;
+    }
+
+    // Compare the last angle with the same angle rendered from scratch.
+    GBitmap *rendering = gbitmap_create_blank(group.rotated->bounds.size);
+    memcpy(rendering->addr, group.rotated->addr, rendering->row_size_bytes * rendering->bounds.size.h);
+    int32_t angle = group.angle;
+    DestroyRotBitmapGroup(&group);
+    DestroyRotationCache();
+
+    if (renderingMatches(pose->resourceId, angle, rendering) == false) {
+      printf("FAIL: %s at %d degrees differs from a fresh rendering\n", pose->name, (int) angle);
+      failures++;
+    }
+
+    gbitmap_destroy(rendering);
+    group.layer = bitmap_layer_create(GRect(0, 0, 0, 0));
+  }
+
+  DestroyRotBitmapGroup(&group);
+  DestroyRotationCache();
+  DestroyBitmapCache();
+  return (failures > 0) ? 1 : 0;
+}
+
+static uint32_t heapAllocs(void) {
+  return HostGetMetrics()->appAllocs + HostGetMetrics()->sdkAllocs;
+}
+
+static bool renderingMatches(uint32_t resourceId, int32_t angle, const GBitmap *rendering) {
+  GBitmap *fresh = RotationCacheAcquire(resourceId, angle);
+  bool matches = (fresh != NULL) &&
+      memcmp(fresh->addr, rendering->addr, rendering->row_size_bytes * rendering->bounds.size.h) == 0;
+  RotationCacheRelease(fresh);
+  DestroyRotationCache();
+  return matches;
+}
@@ -0,0 +1,166 @@
+#define HOST_RUNTIME
+#include "host.h"
+#include "water_layer.h"
+
+// Renders the water rising through every minute of the hour, frame by frame as the
+// minute animation moves it, and reports the cost of a frame two ways: with the water
+// and waves as the stack of 17 InverterLayers they used to be, and with the water layer
+// inverting the framebuffer itself.
+//
+//   water_bench
+//
+// Both are rendered on every frame and must leave the same pixels, or the run fails.
+
+#define RENDER_ITERATIONS 20
+#define RISE_FRAMES (WATER_RISE_DURATION / HOST_ANIMATION_FRAME_INTERVAL)
+
+// The shapes of the waves as waves_layer.c drew them with one InverterLayer per row.
+static const uint16_t _wavesCoordinateX[WAVE_COUNT] = { 4, 40, 76, 112 };
+static const GRect _waveRows[WAVE_HEIGHT] = {
+  { {11, 0}, {6, 1} },
+  { {6, 1}, {16, 1} },
+  { {3, 2}, {22, 1} },
+  { {0, 3}, {28, 1} }
+};
+
+typedef struct {
+  InverterLayer *water;
+  Layer *waves;
+  InverterLayer *waveRows[WAVE_COUNT * WAVE_HEIGHT];
+} InverterStack;
+
+typedef struct {
+  uint32_t frames;
+  uint64_t renderNs;
+} FrameCost;
+
+static void createInverterStack(InverterStack *stack, Layer *parent);
+static void destroyInverterStack(InverterStack *stack);
+static void showInverterStack(InverterStack *stack, bool show, int16_t waterTop);
+static void showWaterLayer(WaterLayerData *data, bool show, int16_t waterTop);
+static void measureRender(FrameCost *cost);
+static void printCost(const char *name, const FrameCost *cost);
+
+int main(int argc, char **argv) {
+  if (argc != 1) {
+    fprintf(stderr, "usage: %s\n", argv[0]);
+    return 2;
+  }
+
+  Window *window = window_create();
+  window_stack_push(window, false);
+  Layer *root = window_get_root_layer(window);
+
+  InverterStack stack;
+  createInverterStack(&stack, root);
+  WaterLayerData *water = CreateWaterLayer(root, CHILD);
+
+  GBitmap *framebuffer = HostFramebuffer();
+  size_t framebufferSize = framebuffer->row_size_bytes * HOST_SCREEN_HEIGHT;
+  uint8_t *expected = malloc(framebufferSize);
+
+  FrameCost stackCost = { 0, 0 };
+  FrameCost waterCost = { 0, 0 };
+  uint32_t mismatches = 0;
+
+  for (uint16_t minute = 1; minute < KEYFRAME_COUNT; minute++) {
+    int32_t fromTop = WATER_TOP(minute - 1);
+    int32_t toTop = WATER_TOP(minute);
+
+    // The frames the linear rise animation shows, from the start to the end of the move.
+    for (int32_t frame = 0; frame <= RISE_FRAMES; frame++) {
+      int32_t distance = frame * ANIMATION_NORMALIZED_MAX / RISE_FRAMES;
+      int16_t waterTop = fromTop + (toTop - fromTop) * distance / ANIMATION_NORMALIZED_MAX;
+
+      showWaterLayer(water, false, waterTop);
+      showInverterStack(&stack, true, waterTop);
+      measureRender(&stackCost);
+      memcpy(expected, framebuffer->addr, framebufferSize);
+
+      showInverterStack(&stack, false, waterTop);
+      showWaterLayer(water, true, waterTop);
+      measureRender(&waterCost);
+
+      if (memcmp(expected, framebuffer->addr, framebufferSize) != 0) {
+        if (mismatches == 0) {
+          fprintf(stderr, "minute %u: water top %d differs from the inverter stack\n", minute, waterTop);
+        }
+
+        mismatches++;
+      }
+    }
+  }
+
+  printf("%-16s %8s %10s\n", "layers", "frames", "frame_us");
+  printCost("inverter stack", &stackCost);
+  printCost("water layer", &waterCost);
+
+  if (mismatches > 0) {
+    printf("FAIL: %u frames differ\n", mismatches);
+  }
+
+  DestroyWaterLayer(water);
+  destroyInverterStack(&stack);
+  window_destroy(window);
+  free(expected);
+  return (mismatches > 0) ? 1 : 0;
+}
+
+static void createInverterStack(InverterStack *stack, Layer *parent) {
+  stack->water = inverter_layer_create(GRectZero);
+  layer_add_child(parent, inverter_layer_get_layer(stack->water));
+
+  stack->waves = layer_create(GRect(0, -1 * WAVE_HEIGHT, SCREEN_WIDTH, WAVE_HEIGHT));
+  for (int wave = 0; wave < WAVE_COUNT; wave++) {
+    for (int waveRow = 0; waveRow < WAVE_HEIGHT; waveRow++) {
+      GRect row = _waveRows[waveRow];
+      row.origin.x += _wavesCoordinateX[wave];
+
+      InverterLayer *inverter = inverter_layer_create(row);
+      stack->waveRows[wave * WAVE_HEIGHT + waveRow] = inverter;
+      layer_add_child(stack->waves, inverter_layer_get_layer(inverter));
+    }
+  }
+
+  layer_add_child(parent, stack->waves);
+}
+
+static void destroyInverterStack(InverterStack *stack) {
+  for (int index = 0; index < WAVE_COUNT * WAVE_HEIGHT; index++) {
+    inverter_layer_destroy(stack->waveRows[index]);
+  }
+
+  layer_destroy(stack->waves);
+  inverter_layer_destroy(stack->water);
+}
+
+// Puts the stack where the water and waves layers put it with the water at waterTop.
+static void showInverterStack(InverterStack *stack, bool show, int16_t waterTop) {
+  Layer *water = inverter_layer_get_layer(stack->water);
+  layer_set_frame(water, GRect(0, waterTop, SCREEN_WIDTH, SCREEN_HEIGHT - waterTop));
+  layer_set_frame(stack->waves, GRect(0, waterTop - WAVE_HEIGHT, SCREEN_WIDTH, WAVE_HEIGHT));
+  layer_set_hidden(water, show == false);
+  layer_set_hidden(stack->waves, show == false);
+}
+
+static void showWaterLayer(WaterLayerData *data, bool show, int16_t waterTop) {
+  layer_set_frame(data->layer, GRect(0, waterTop - WAVE_HEIGHT, SCREEN_WIDTH, (SCREEN_HEIGHT - waterTop) + WAVE_HEIGHT));
+  layer_set_hidden(data->layer, show == false);
+}
+
+// Renders the frame RENDER_ITERATIONS times and keeps the average.
+static void measureRender(FrameCost *cost) {
+  uint64_t start = HostCpuNs();
+  for (int iteration = 0; iteration < RENDER_ITERATIONS; iteration++) {
+    HostMarkDirty();
+    HostRender();
+  }
+
+  cost->renderNs += (HostCpuNs() - start) / RENDER_ITERATIONS;
+  cost->frames++;
+}
+
+static void printCost(const char *name, const FrameCost *cost) {
+  double frameUs = (cost->frames > 0) ? (cost->renderNs / 1000.0 / cost->frames) : 0;
+  printf("%-16s %8u %10.2f\n", name, cost->frames, frameUs);
+}
\ No newline at end of file
@@ -0,0 +1,75 @@
+#!/usr/bin/env python
+#
+# Generates resource_ids.auto.h and resources.auto.c for the host build from the
+# media list in appinfo.json, the same way the Pebble SDK numbers resources. Images are
+# embedded packed by tools/pack_sprites.py, as the SDK stores them on the watch.
+#
+# Usage: gen_resources.py <appinfo.json> <resources dir> <header out> <source out>
+#
+
+import json
+import os
+import sys
+
+sys.path.insert(0, os.path.join(os.path.dirname(os.path.dirname(os.path.abspath(__file__))), 'tools'))
+from pack_sprites import pack_image
+
+
+def load_media(appinfo_path):
+    with open(appinfo_path) as appinfo:
+        return json.load(appinfo)['resources']['media']
+
+
+def write_header(media, path):
+    with open(path, 'w') as out:
+        out.write('#pragma once\n\n')
+        out.write('// Generated by host/gen_resources.py. Do not edit.\n\n')
+        out.write('typedef enum {\n')
+        out.write('  INVALID_RESOURCE = 0,\n')
+        for index, entry in enumerate(media):
+            out.write('  RESOURCE_ID_%s = %d,\n' % (entry['name'], index + 1))
+        out.write('} ResourceId;\n')
+
+
+def write_source(media, resources_dir, path):
+    with open(path, 'w') as out:
+        out.write('// Generated by host/gen_resources.py. Do not edit.\n\n')
+        out.write('#define HOST_RUNTIME\n')
+        out.write('#include "host.h"\n\n')
+
+        for index, entry in enumerate(media):
+            path = os.path.join(resources_dir, entry['file'])
+            if entry['type'] == 'png':
+                data = bytearray(pack_image(path))
+            else:
+                with open(path, 'rb') as resource:
+                    data = bytearray(resource.read())
+
+            out.write('static const uint8_t _resource%d[%d] = {\n' % (index + 1, len(data)))
+            for offset in range(0, len(data), 16):
+                row = ', '.join('0x%02x' % byte for byte in data[offset:offset + 16])
+                out.write('  %s,\n' % row)
+            out.write('};\n\n')
+
+        out.write('const HostResource HostResources[] = {\n')
+        out.write('  { "INVALID_RESOURCE", "", NULL, 0 },\n')
+        for index, entry in enumerate(media):
+            out.write('  { "%s", "%s", _resource%d, sizeof(_resource%d) },\n' %
+                      (entry['name'], entry['file'], index + 1, index + 1))
+        out.write('};\n\n')
+        out.write('const uint32_t HostResourceCount = %d;\n' % (len(media) + 1))
+
+
+def main(argv):
+    if len(argv) != 5:
+        sys.stderr.write('usage: %s <appinfo.json> <resources dir> <header out> <source out>\n' % argv[0])
+        return 1
+
+    media = load_media(argv[1])
+    write_header(media, argv[3])
+    write_source(media, argv[2], argv[4])
+    return 0
+
+
+if __name__ == '__main__':
+    sys.exit(main(sys.argv))
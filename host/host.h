@@ -0,0 +1,130 @@
+#pragma once
+#include "pebble.h"
+
+// Control and measurement interface of the host stand-in. Everything here is host-only;
+// the watchface code in src/ only ever sees pebble.h.
+
+#define HOST_SCREEN_WIDTH 144
+#define HOST_SCREEN_HEIGHT 168
+#define HOST_FRAMEBUFFER_ROW_SIZE 20
+
+// Interval between animation frames, as on the watch.
+#define HOST_ANIMATION_FRAME_INTERVAL 33
+
+#define HOST_MAX_TAPS 32
+
+typedef struct {
+  time_t startTime;             // Virtual wall clock at launch (UTC)
+  uint32_t durationSeconds;     // Simulated time before app_event_loop() returns
+  uint32_t tapSeconds[HOST_MAX_TAPS];
+  uint16_t tapCount;
+  uint8_t batteryPercent;
+  bool batteryCharging;
+  bool clock24Hour;
+  bool bluetoothConnected;
+  bool logging;
+  const char *framebufferPath;  // PBM dump of the screen at exit, or NULL
+} HostConfig;
+
+typedef struct {
+  // Virtual time
+  uint64_t simulatedMs;
+  uint32_t wakeups;             // Distinct virtual instants at which the app was woken
+  uint32_t tickEvents;
+  uint32_t tapEvents;
+  uint32_t timersRegistered;
+  uint32_t timersFired;
+  uint32_t animationsScheduled;
+  uint32_t animationFrames;
+
+  // Rendering
+  uint32_t framesRendered;
+  uint32_t updateProcCalls;
+  uint64_t pixelsTouched;       // Pixels read-modify-written by the rasterizer
+  uint64_t dirtyPixels;         // Area invalidated by the app before each redraw
+
+  // Resources
+  uint32_t bitmapsDecoded;      // Bitmaps loaded from resources, packed or PNG
+  uint64_t bitmapBytesDecoded;
+
+  // Heap (watchface allocations plus SDK objects allocated on its behalf)
+  size_t heapCurrent;
+  size_t heapPeak;
+  uint32_t appAllocs;
+  uint32_t sdkAllocs;
+  uint32_t tickAppAllocs;       // appAllocs made by minute ticks that did not start a new day
+
+  // Storage and messaging
+  uint32_t persistWrites;
+  uint32_t persistBytesWritten;
+  uint32_t persistReads;
+  uint32_t appMessageInboxSize;
+  uint32_t appMessageOutboxSize;
+
+  // Host CPU time spent in watchface callbacks and in rendering
+  uint64_t callbackCpuNs;
+  uint64_t renderCpuNs;
+} HostMetrics;
+
+// Config and lifecycle (host_loop.c)
+HostConfig* HostGetConfig(void);
+void HostLoadConfigFromEnvironment(HostConfig *config);
+HostMetrics* HostGetMetrics(void);
+void HostPrintReport(FILE *out);
+uint64_t HostNowMs(void);
+uint64_t HostCpuNs(void);
+
+// Event injection
+void HostDeliverInbox(const Tuplet *tuplets, uint8_t count);
+void HostSetBattery(uint8_t percent, bool charging);
+void HostSetBluetooth(bool connected);
+
+// Heap accounting (host_heap.c)
+void* HostSdkMalloc(size_t size);
+void* HostSdkCalloc(size_t count, size_t size);
+void HostSdkFree(void *ptr);
+size_t HostHeapBlocks(void);
+
+// Rendering (host_layer.c, host_graphics.c)
+void HostMarkDirty(void);
+bool HostIsDirty(void);
+void HostRender(void);
+GBitmap* HostFramebuffer(void);
+void HostWriteFramebuffer(const char *path);
+void HostRenderLayer(Layer *layer, GContext *ctx);
+GContext* HostGraphicsContext(void);
+void HostContextSetDrawingBox(GContext *ctx, GRect drawingBox, GRect clipBox);
+void HostContextReset(GContext *ctx);
+void HostInvertRect(GContext *ctx, GRect rect);
+void HostDrawRotatedBitmap(GContext *ctx, const GBitmap *bitmap, GPoint srcCenter, GPoint destCenter,
+                           int32_t angle, GCompOp mode);
+
+// Animations (host_animation.c)
+int64_t HostAnimationNextFrame(void);
+void HostAnimationRunFrame(uint64_t now);
+uint32_t HostAnimationScheduledCount(void);
+
+// Timers (host_loop.c)
+int64_t HostTimerNextDue(void);
+void HostTimerRunDue(uint64_t now);
+
+// Storage (host_storage.c)
+void HostPersistReset(void);
+void HostAppMessageRunPending(void);
+bool HostAppMessagePending(void);
+void HostAppMessageClose(void);
+
+// Resources (host_graphics.c, generated resources.auto.c)
+typedef struct {
+  const char *name;
+  const char *file;
+  const uint8_t *data;
+  uint32_t size;
+} HostResource;
+
+extern const HostResource HostResources[];
+extern const uint32_t HostResourceCount;
+
+const HostResource* HostGetResource(uint32_t resourceId);
+GBitmap* HostLoadPackedBitmap(const uint8_t *data, uint32_t size);
+GBitmap* HostDecodePng(const uint8_t *data, uint32_t size);
@@ -0,0 +1,328 @@
+#define HOST_RUNTIME
+#include "host.h"
+
+static Animation *_scheduled = NULL;
+static int64_t _nextFrame = -1;
+
+static const PropertyAnimationImplementation _layerFrameImplementation;
+
+static void removeScheduled(Animation *animation);
+static void stopAnimation(Animation *animation, bool finished);
+static void updateNextFrame(uint64_t now);
+static AnimationProgress applyCurve(Animation *animation, AnimationProgress progress);
+static void layerFrameSetter(void *subject, GRect frame);
+static GRect layerFrameGetter(void *subject);
+static void propertyAnimationUpdate(Animation *animation, const uint32_t distance_normalized);
+
+////////////////////////////////////////////
+// Animation
+////////////////////////////////////////////
+
+Animation* animation_create(void) {
+  Animation *animation = HostSdkCalloc(1, sizeof(Animation));
+  if (animation != NULL) {
+    animation->duration = 250;
+    animation->curve = AnimationCurveEaseInOut;
+  }
+
+  return animation;
+}
+
+void animation_destroy(Animation *animation) {
+  if (animation == NULL) {
+    return;
+  }
+
+  animation_unschedule(animation);
+  HostSdkFree(animation);
+}
+
+void animation_set_delay(Animation *animation, uint32_t delay_ms) {
+  animation->delay = delay_ms;
+}
+
+void animation_set_duration(Animation *animation, uint32_t duration_ms) {
+  animation->duration = duration_ms;
+}
+
+void animation_set_curve(Animation *animation, AnimationCurve curve) {
+  animation->curve = curve;
+}
+
+void animation_set_custom_curve(Animation *animation, AnimationCurveFunction curve_function) {
+  animation->curve = AnimationCurveCustomFunction;
+  animation->custom_curve = curve_function;
+}
+
+void animation_set_handlers(Animation *animation, AnimationHandlers callbacks, void *context) {
+  animation->handlers = callbacks;
+  animation->context = context;
+}
+
+void* animation_get_context(Animation *animation) {
+  return animation->context;
+}
+
+void animation_set_implementation(Animation *animation, const AnimationImplementation *implementation) {
+  animation->implementation = implementation;
+}
+
+void animation_schedule(Animation *animation) {
+  if (animation->is_scheduled) {
+    animation_unschedule(animation);
+  }
+
+  uint64_t now = HostNowMs();
+  animation->is_scheduled = true;
+  animation->is_started = false;
+  animation->start_time = now + animation->delay;
+  animation->next = _scheduled;
+  _scheduled = animation;
+  HostGetMetrics()->animationsScheduled++;
+
+  if (animation->implementation != NULL && animation->implementation->setup != NULL) {
+    animation->implementation->setup(animation);
+  }
+
+  updateNextFrame(now);
+}
+
+void animation_unschedule(Animation *animation) {
+  if (animation == NULL || animation->is_scheduled == false) {
+    return;
+  }
+
+  stopAnimation(animation, false);
+}
+
+void animation_unschedule_all(void) {
+  while (_scheduled != NULL) {
+    stopAnimation(_scheduled, false);
+  }
+}
+
+bool animation_is_scheduled(Animation *animation) {
+  return animation->is_scheduled;
+}
+
+////////////////////////////////////////////
+// PropertyAnimation
+////////////////////////////////////////////
+
+PropertyAnimation* property_animation_create_layer_frame(Layer *layer, GRect *from_frame, GRect *to_frame) {
+  PropertyAnimation *propertyAnimation = HostSdkCalloc(1, sizeof(PropertyAnimation));
+  if (propertyAnimation == NULL) {
+    return NULL;
+  }
+
+  Animation *animation = &propertyAnimation->animation;
+  animation->duration = 250;
+  animation->curve = AnimationCurveEaseInOut;
+  animation->is_property_animation = true;
+  animation->implementation = &_layerFrameImplementation.base;
+
+  propertyAnimation->subject = layer;
+  propertyAnimation->accessors = _layerFrameImplementation.accessors;
+  propertyAnimation->from.grect = (from_frame != NULL) ? *from_frame : layer_get_frame(layer);
+  propertyAnimation->to.grect = (to_frame != NULL) ? *to_frame : layer_get_frame(layer);
+  return propertyAnimation;
+}
+
+void property_animation_destroy(PropertyAnimation *property_animation) {
+  animation_destroy((Animation*) property_animation);
+}
+
+void property_animation_update_grect(PropertyAnimation *property_animation, const uint32_t distance_normalized) {
+  GRect from = property_animation->from.grect;
+  GRect to = property_animation->to.grect;
+  int32_t distance = distance_normalized;
+
+  GRect frame = GRect(from.origin.x + ((to.origin.x - from.origin.x) * distance / ANIMATION_NORMALIZED_MAX),
+                      from.origin.y + ((to.origin.y - from.origin.y) * distance / ANIMATION_NORMALIZED_MAX),
+                      from.size.w + ((to.size.w - from.size.w) * distance / ANIMATION_NORMALIZED_MAX),
+                      from.size.h + ((to.size.h - from.size.h) * distance / ANIMATION_NORMALIZED_MAX));
+
+  property_animation->accessors.setter(property_animation->subject, frame);
+}
+
+static void propertyAnimationUpdate(Animation *animation, const uint32_t distance_normalized) {
+  property_animation_update_grect((PropertyAnimation*) animation, distance_normalized);
+}
+
+static void layerFrameSetter(void *subject, GRect frame) {
+  layer_set_frame((Layer*) subject, frame);
+}
+
+static GRect layerFrameGetter(void *subject) {
+  return layer_get_frame((Layer*) subject);
+}
+
+static const PropertyAnimationImplementation _layerFrameImplementation = {
+  .base = {
+    .update = propertyAnimationUpdate,
+  },
+  .accessors = {
+    .setter = layerFrameSetter,
+    .getter = layerFrameGetter,
+  },
+};
+
+////////////////////////////////////////////
+// Frame engine
+////////////////////////////////////////////
+
+int64_t HostAnimationNextFrame(void) {
+  return _nextFrame;
+}
+
+uint32_t HostAnimationScheduledCount(void) {
+  uint32_t count = 0;
+  for (Animation *animation = _scheduled; animation != NULL; animation = animation->next) {
+    count++;
+  }
+
+  return count;
+}
+
+// Advances every scheduled animation to time now. Handlers may unschedule, destroy and
+// schedule animations, so the list is re-walked after every callback.
+void HostAnimationRunFrame(uint64_t now) {
+  HostGetMetrics()->animationFrames++;
+  _nextFrame = -1;
+
+  Animation *pending[64];
+  uint16_t pendingCount = 0;
+  for (Animation *animation = _scheduled; animation != NULL && pendingCount < 64; animation = animation->next) {
+    pending[pendingCount++] = animation;
+  }
+
+  for (uint16_t index = 0; index < pendingCount; index++) {
+    Animation *animation = pending[index];
+
+    // Skip animations that an earlier callback in this frame removed.
+    bool stillScheduled = false;
+    for (Animation *check = _scheduled; check != NULL; check = check->next) {
+      if (check == animation) {
+        stillScheduled = true;
+        break;
+      }
+    }
+
+    if (stillScheduled == false || (int64_t) now < animation->start_time) {
+      continue;
+    }
+
+    if (animation->is_started == false) {
+      animation->is_started = true;
+      if (animation->handlers.started != NULL) {
+        animation->handlers.started(animation, animation->context);
+      }
+
+      if (animation->is_scheduled == false) {
+        continue;
+      }
+    }
+
+    uint64_t elapsed = now - animation->start_time;
+    bool finished = (animation->duration != ANIMATION_DURATION_INFINITE && elapsed >= animation->duration);
+    AnimationProgress progress = ANIMATION_NORMALIZED_MAX;
+    if (finished == false) {
+      progress = (animation->duration == ANIMATION_DURATION_INFINITE) ? 0 :
+                 (AnimationProgress) (elapsed * ANIMATION_NORMALIZED_MAX / animation->duration);
+    }
+
+    if (animation->implementation != NULL && animation->implementation->update != NULL) {
+      animation->implementation->update(animation, applyCurve(animation, progress));
+    }
+
+    if (finished && animation->is_scheduled) {
+      stopAnimation(animation, true);
+    }
+  }
+
+  updateNextFrame(now);
+}
+
+static void updateNextFrame(uint64_t now) {
+  if (_scheduled == NULL) {
+    _nextFrame = -1;
+    return;
+  }
+
+  // Frames run at the regular interval while an animation is running, otherwise the
+  // engine sleeps until the first delayed animation starts.
+  int64_t earliestStart = -1;
+  bool running = false;
+  for (Animation *animation = _scheduled; animation != NULL; animation = animation->next) {
+    if (animation->start_time <= (int64_t) now) {
+      running = true;
+
+    } else if (earliestStart < 0 || animation->start_time < earliestStart) {
+      earliestStart = animation->start_time;
+    }
+  }
+
+  int64_t next = running ? (int64_t) now + HOST_ANIMATION_FRAME_INTERVAL : earliestStart;
+  if (running == false && next < (int64_t) now + HOST_ANIMATION_FRAME_INTERVAL) {
+    next = now + HOST_ANIMATION_FRAME_INTERVAL;
+  }
+
+  if (_nextFrame < 0 || next < _nextFrame) {
+    _nextFrame = next;
+  }
+}
+
+static void removeScheduled(Animation *animation) {
+  Animation **link = &_scheduled;
+  while (*link != NULL) {
+    if (*link == animation) {
+      *link = animation->next;
+      break;
+    }
+
+    link = &(*link)->next;
+  }
+
+  animation->next = NULL;
+  animation->is_scheduled = false;
+}
+
+static void stopAnimation(Animation *animation, bool finished) {
+  removeScheduled(animation);
+
+  if (animation->handlers.stopped != NULL) {
+    animation->handlers.stopped(animation, finished, animation->context);
+  }
+
+  // The stopped handler may have destroyed the animation, so it is not touched again
+  // unless it was rescheduled.
+  if (_scheduled == NULL) {
+    _nextFrame = -1;
+  }
+}
+
+static AnimationProgress applyCurve(Animation *animation, AnimationProgress progress) {
+  uint64_t t = progress;
+  uint64_t max = ANIMATION_NORMALIZED_MAX;
+
+  switch (animation->curve) {
+    case AnimationCurveEaseIn:
+      return (AnimationProgress) (t * t / max);
+
+    case AnimationCurveEaseOut:
+      return (AnimationProgress) (max - ((max - t) * (max - t) / max));
+
+    case AnimationCurveEaseInOut:
+      if (t < max / 2) {
+        return (AnimationProgress) (2 * t * t / max);
+      }
+
+      return (AnimationProgress) (max - (2 * (max - t) * (max - t) / max));
+
+    case AnimationCurveCustomFunction:
+      return (animation->custom_curve != NULL) ? animation->custom_curve(progress) : progress;
+
+    default:
+      return progress;
+  }
+}
@@ -0,0 +1,733 @@
+#define HOST_RUNTIME
+#include "host.h"
+#include <math.h>
+#include <zlib.h>
+
+#define BITMAP_OWNS_DATA 0x0001
+#define MAX_FONTS 8
+
+// Row size, info flags and bounds ahead of the rows of a packed bitmap.
+#define PACKED_BITMAP_HEADER_SIZE 12
+
+struct GContext {
+  GBitmap framebuffer;
+  GRect drawingBox;     // Screen coordinates of the layer bounds being drawn
+  GRect clipBox;        // Screen coordinates drawing is clipped to
+  GColor strokeColor;
+  GColor fillColor;
+  GColor textColor;
+  GCompOp compositingMode;
+  bool captured;
+};
+
+struct FontInfo {
+  char key[40];
+  int16_t height;
+};
+
+// Word aligned like the watch's, which the water layer inverts a word at a time.
+static uint8_t _framebufferPixels[HOST_SCREEN_HEIGHT * HOST_FRAMEBUFFER_ROW_SIZE] __attribute__((aligned(4)));
+static GContext _context;
+static bool _contextInitialized = false;
+static struct FontInfo _fonts[MAX_FONTS];
+static uint16_t _fontCount = 0;
+
+static inline bool getPixel(const GBitmap *bitmap, int16_t x, int16_t y);
+static inline void setPixel(GBitmap *bitmap, int16_t x, int16_t y, bool white);
+static inline bool isClipped(GContext *ctx, int16_t x, int16_t y);
+static void fillPixel(GContext *ctx, int16_t x, int16_t y, GColor color);
+static void compositePixel(GContext *ctx, int16_t x, int16_t y, bool src, GCompOp mode);
+static GRect intersectRect(GRect a, GRect b);
+static uint16_t bitmapRowSize(int16_t width);
+static uint32_t readBigEndian(const uint8_t *data);
+static uint8_t paeth(uint8_t a, uint8_t b, uint8_t c);
+
+////////////////////////////////////////////
+// Geometry
+////////////////////////////////////////////
+
+GPoint grect_center_point(const GRect *rect) {
+  return GPoint(rect->origin.x + (rect->size.w / 2), rect->origin.y + (rect->size.h / 2));
+}
+
+bool grect_equal(const GRect *const rect_a, const GRect *const rect_b) {
+  return memcmp(rect_a, rect_b, sizeof(GRect)) == 0;
+}
+
+bool gpoint_equal(const GPoint *const point_a, const GPoint *const point_b) {
+  return point_a->x == point_b->x && point_a->y == point_b->y;
+}
+
+int32_t sin_lookup(int32_t angle) {
+  return (int32_t) lround(sin(2.0 * M_PI * angle / TRIG_MAX_ANGLE) * TRIG_MAX_RATIO);
+}
+
+int32_t cos_lookup(int32_t angle) {
+  return (int32_t) lround(cos(2.0 * M_PI * angle / TRIG_MAX_ANGLE) * TRIG_MAX_RATIO);
+}
+
+////////////////////////////////////////////
+// Context
+////////////////////////////////////////////
+
+GContext* HostGraphicsContext(void) {
+  if (_contextInitialized == false) {
+    memset(&_context, 0, sizeof(GContext));
+    _context.framebuffer.addr = _framebufferPixels;
+    _context.framebuffer.row_size_bytes = HOST_FRAMEBUFFER_ROW_SIZE;
+    _context.framebuffer.bounds = GRect(0, 0, HOST_SCREEN_WIDTH, HOST_SCREEN_HEIGHT);
+    _contextInitialized = true;
+    HostContextReset(&_context);
+  }
+
+  return &_context;
+}
+
+GBitmap* HostFramebuffer(void) {
+  return &HostGraphicsContext()->framebuffer;
+}
+
+void HostContextReset(GContext *ctx) {
+  ctx->strokeColor = GColorBlack;
+  ctx->fillColor = GColorBlack;
+  ctx->textColor = GColorBlack;
+  ctx->compositingMode = GCompOpAssign;
+  ctx->drawingBox = GRect(0, 0, HOST_SCREEN_WIDTH, HOST_SCREEN_HEIGHT);
+  ctx->clipBox = ctx->drawingBox;
+}
+
+void HostContextSetDrawingBox(GContext *ctx, GRect drawingBox, GRect clipBox) {
+  ctx->drawingBox = drawingBox;
+  ctx->clipBox = intersectRect(clipBox, GRect(0, 0, HOST_SCREEN_WIDTH, HOST_SCREEN_HEIGHT));
+}
+
+void HostWriteFramebuffer(const char *path) {
+  FILE *file = fopen(path, "wb");
+  if (file == NULL) {
+    return;
+  }
+
+  // PBM uses 1 for black, most significant bit first.
+  fprintf(file, "P4\n%d %d\n", HOST_SCREEN_WIDTH, HOST_SCREEN_HEIGHT);
+  GBitmap *framebuffer = HostFramebuffer();
+  for (int16_t y = 0; y < HOST_SCREEN_HEIGHT; y++) {
+    for (int16_t x = 0; x < HOST_SCREEN_WIDTH; x += 8) {
+      uint8_t byte = 0;
+      for (int16_t bit = 0; bit < 8; bit++) {
+        if (getPixel(framebuffer, x + bit, y) == false) {
+          byte |= (0x80 >> bit);
+        }
+      }
+
+      fputc(byte, file);
+    }
+  }
+
+  fclose(file);
+}
+
+void graphics_context_set_stroke_color(GContext *ctx, GColor color) {
+  ctx->strokeColor = color;
+}
+
+void graphics_context_set_fill_color(GContext *ctx, GColor color) {
+  ctx->fillColor = color;
+}
+
+void graphics_context_set_text_color(GContext *ctx, GColor color) {
+  ctx->textColor = color;
+}
+
+void graphics_context_set_compositing_mode(GContext *ctx, GCompOp mode) {
+  ctx->compositingMode = mode;
+}
+
+GBitmap* graphics_capture_frame_buffer(GContext *ctx) {
+  if (ctx->captured) {
+    return NULL;
+  }
+
+  ctx->captured = true;
+  return &ctx->framebuffer;
+}
+
+bool graphics_release_frame_buffer(GContext *ctx, GBitmap *buffer) {
+  if (ctx->captured == false || buffer != &ctx->framebuffer) {
+    return false;
+  }
+
+  ctx->captured = false;
+  return true;
+}
+
+bool graphics_frame_buffer_is_captured(GContext *ctx) {
+  return ctx->captured;
+}
+
+////////////////////////////////////////////
+// Primitives
+////////////////////////////////////////////
+
+void graphics_draw_pixel(GContext *ctx, GPoint point) {
+  fillPixel(ctx, ctx->drawingBox.origin.x + point.x, ctx->drawingBox.origin.y + point.y, ctx->strokeColor);
+}
+
+void graphics_draw_line(GContext *ctx, GPoint p0, GPoint p1) {
+  int16_t dx = abs(p1.x - p0.x);
+  int16_t dy = -abs(p1.y - p0.y);
+  int16_t sx = (p0.x < p1.x) ? 1 : -1;
+  int16_t sy = (p0.y < p1.y) ? 1 : -1;
+  int16_t error = dx + dy;
+
+  while (true) {
+    graphics_draw_pixel(ctx, p0);
+    if (p0.x == p1.x && p0.y == p1.y) {
+      break;
+    }
+
+    int16_t error2 = 2 * error;
+    if (error2 >= dy) {
+      error += dy;
+      p0.x += sx;
+    }
+
+    if (error2 <= dx) {
+      error += dx;
+      p0.y += sy;
+    }
+  }
+}
+
+void graphics_draw_rect(GContext *ctx, GRect rect) {
+  int16_t right = rect.origin.x + rect.size.w - 1;
+  int16_t bottom = rect.origin.y + rect.size.h - 1;
+  graphics_draw_line(ctx, rect.origin, GPoint(right, rect.origin.y));
+  graphics_draw_line(ctx, GPoint(right, rect.origin.y), GPoint(right, bottom));
+  graphics_draw_line(ctx, GPoint(right, bottom), GPoint(rect.origin.x, bottom));
+  graphics_draw_line(ctx, GPoint(rect.origin.x, bottom), rect.origin);
+}
+
+void graphics_fill_rect(GContext *ctx, GRect rect, uint16_t corner_radius, GCornerMask corner_mask) {
+  int16_t left = ctx->drawingBox.origin.x + rect.origin.x;
+  int16_t top = ctx->drawingBox.origin.y + rect.origin.y;
+
+  for (int16_t y = 0; y < rect.size.h; y++) {
+    for (int16_t x = 0; x < rect.size.w; x++) {
+      if (corner_radius > 0 && corner_mask != GCornerNone) {
+        // Skip pixels outside the rounded corners.
+        int16_t cx = (x < corner_radius) ? corner_radius - x : ((x >= rect.size.w - corner_radius) ? x - (rect.size.w - corner_radius - 1) : 0);
+        int16_t cy = (y < corner_radius) ? corner_radius - y : ((y >= rect.size.h - corner_radius) ? y - (rect.size.h - corner_radius - 1) : 0);
+        if (cx > 0 && cy > 0 && (cx * cx + cy * cy) > (corner_radius * corner_radius)) {
+          continue;
+        }
+      }
+
+      fillPixel(ctx, left + x, top + y, ctx->fillColor);
+    }
+  }
+}
+
+void graphics_draw_circle(GContext *ctx, GPoint p, uint16_t radius) {
+  int16_t x = radius;
+  int16_t y = 0;
+  int16_t error = 1 - x;
+  int16_t originX = ctx->drawingBox.origin.x + p.x;
+  int16_t originY = ctx->drawingBox.origin.y + p.y;
+
+  while (x >= y) {
+    fillPixel(ctx, originX + x, originY + y, ctx->strokeColor);
+    fillPixel(ctx, originX + y, originY + x, ctx->strokeColor);
+    fillPixel(ctx, originX - y, originY + x, ctx->strokeColor);
+    fillPixel(ctx, originX - x, originY + y, ctx->strokeColor);
+    fillPixel(ctx, originX - x, originY - y, ctx->strokeColor);
+    fillPixel(ctx, originX - y, originY - x, ctx->strokeColor);
+    fillPixel(ctx, originX + y, originY - x, ctx->strokeColor);
+    fillPixel(ctx, originX + x, originY - y, ctx->strokeColor);
+    y++;
+
+    if (error < 0) {
+      error += 2 * y + 1;
+
+    } else {
+      x--;
+      error += 2 * (y - x) + 1;
+    }
+  }
+}
+
+void graphics_fill_circle(GContext *ctx, GPoint p, uint16_t radius) {
+  int16_t originX = ctx->drawingBox.origin.x + p.x;
+  int16_t originY = ctx->drawingBox.origin.y + p.y;
+  int32_t radiusSquared = radius * radius + radius;
+
+  for (int16_t dy = -radius; dy <= radius; dy++) {
+    for (int16_t dx = -radius; dx <= radius; dx++) {
+      if ((dx * dx + dy * dy) <= radiusSquared) {
+        fillPixel(ctx, originX + dx, originY + dy, ctx->fillColor);
+      }
+    }
+  }
+}
+
+void graphics_draw_bitmap_in_rect(GContext *ctx, const GBitmap *bitmap, GRect rect) {
+  if (bitmap == NULL || bitmap->bounds.size.w <= 0 || bitmap->bounds.size.h <= 0) {
+    return;
+  }
+
+  int16_t left = ctx->drawingBox.origin.x + rect.origin.x;
+  int16_t top = ctx->drawingBox.origin.y + rect.origin.y;
+
+  // The bitmap is tiled if the rect is larger than the bitmap.
+  for (int16_t y = 0; y < rect.size.h; y++) {
+    int16_t srcY = bitmap->bounds.origin.y + (y % bitmap->bounds.size.h);
+    for (int16_t x = 0; x < rect.size.w; x++) {
+      int16_t srcX = bitmap->bounds.origin.x + (x % bitmap->bounds.size.w);
+      compositePixel(ctx, left + x, top + y, getPixel(bitmap, srcX, srcY), ctx->compositingMode);
+    }
+  }
+}
+
+void HostDrawRotatedBitmap(GContext *ctx, const GBitmap *bitmap, GPoint srcCenter, GPoint destCenter,
+                           int32_t angle, GCompOp mode) {
+  if (bitmap == NULL) {
+    return;
+  }
+
+  int32_t sine = sin_lookup(angle);
+  int32_t cosine = cos_lookup(angle);
+  GRect area = intersectRect(ctx->drawingBox, ctx->clipBox);
+
+  // Map every destination pixel back into the source bitmap.
+  for (int16_t y = area.origin.y; y < area.origin.y + area.size.h; y++) {
+    for (int16_t x = area.origin.x; x < area.origin.x + area.size.w; x++) {
+      int32_t dx = x - (ctx->drawingBox.origin.x + destCenter.x);
+      int32_t dy = y - (ctx->drawingBox.origin.y + destCenter.y);
+      int32_t srcX = srcCenter.x + (int32_t) floor((double) (dx * cosine + dy * sine) / TRIG_MAX_RATIO + 0.5);
+      int32_t srcY = srcCenter.y + (int32_t) floor((double) (dy * cosine - dx * sine) / TRIG_MAX_RATIO + 0.5);
+
+      HostGetMetrics()->pixelsTouched++;
+      if (srcX < 0 || srcY < 0 || srcX >= bitmap->bounds.size.w || srcY >= bitmap->bounds.size.h) {
+        continue;
+      }
+
+      compositePixel(ctx, x, y, getPixel(bitmap, bitmap->bounds.origin.x + srcX, bitmap->bounds.origin.y + srcY), mode);
+    }
+  }
+}
+
+void HostInvertRect(GContext *ctx, GRect rect) {
+  GRect area = intersectRect(GRect(ctx->drawingBox.origin.x + rect.origin.x, ctx->drawingBox.origin.y + rect.origin.y,
+                                   rect.size.w, rect.size.h), ctx->clipBox);
+
+  for (int16_t y = area.origin.y; y < area.origin.y + area.size.h; y++) {
+    for (int16_t x = area.origin.x; x < area.origin.x + area.size.w; x++) {
+      setPixel(&ctx->framebuffer, x, y, getPixel(&ctx->framebuffer, x, y) == false);
+      HostGetMetrics()->pixelsTouched++;
+    }
+  }
+}
+
+////////////////////////////////////////////
+// Text
+////////////////////////////////////////////
+
+GFont fonts_get_system_font(const char *font_key) {
+  for (uint16_t index = 0; index < _fontCount; index++) {
+    if (strcmp(_fonts[index].key, font_key) == 0) {
+      return &_fonts[index];
+    }
+  }
+
+  if (_fontCount == MAX_FONTS) {
+    return &_fonts[0];
+  }
+
+  struct FontInfo *font = &_fonts[_fontCount++];
+  snprintf(font->key, sizeof(font->key), "%s", font_key);
+  font->height = 14;
+
+  const char *size = strpbrk(font_key, "0123456789");
+  if (size != NULL) {
+    font->height = atoi(size);
+  }
+
+  return font;
+}
+
+// There are no system fonts on the host, so each character is drawn as an outlined
+// cell of the font's size. That keeps text cost proportional to what is rendered.
+void graphics_draw_text(GContext *ctx, const char *text, GFont const font, const GRect box,
+                        const GTextOverflowMode overflow_mode, const GTextAlignment alignment, void *layout) {
+  if (text == NULL || font == NULL || ctx->textColor == GColorClear) {
+    return;
+  }
+
+  int16_t cellWidth = font->height / 2;
+  int16_t cellHeight = (font->height * 3) / 4;
+  int16_t perLine = (cellWidth > 0) ? box.size.w / cellWidth : 0;
+  if (perLine <= 0) {
+    return;
+  }
+
+  size_t length = strlen(text);
+  for (size_t lineStart = 0, line = 0; lineStart < length; lineStart += perLine, line++) {
+    int16_t top = box.origin.y + (line * font->height) + (font->height - cellHeight);
+    if (top + cellHeight > box.origin.y + box.size.h) {
+      break;
+    }
+
+    size_t lineLength = ((length - lineStart) < (size_t) perLine) ? (length - lineStart) : (size_t) perLine;
+    int16_t left = box.origin.x;
+    if (alignment == GTextAlignmentCenter) {
+      left += (box.size.w - (int16_t) lineLength * cellWidth) / 2;
+
+    } else if (alignment == GTextAlignmentRight) {
+      left += box.size.w - (int16_t) lineLength * cellWidth;
+    }
+
+    for (size_t index = 0; index < lineLength; index++) {
+      if (text[lineStart + index] == ' ') {
+        continue;
+      }
+
+      int16_t cellLeft = ctx->drawingBox.origin.x + left + (int16_t) index * cellWidth;
+      int16_t cellTop = ctx->drawingBox.origin.y + top;
+      for (int16_t y = 0; y < cellHeight; y++) {
+        for (int16_t x = 0; x < cellWidth - 1; x++) {
+          if (y == 0 || y == cellHeight - 1 || x == 0 || x == cellWidth - 2) {
+            fillPixel(ctx, cellLeft + x, cellTop + y, ctx->textColor);
+          }
+        }
+      }
+    }
+  }
+}
+
+////////////////////////////////////////////
+// Bitmaps
+////////////////////////////////////////////
+
+GBitmap* gbitmap_create_blank(GSize size) {
+  GBitmap *bitmap = HostSdkCalloc(1, sizeof(GBitmap));
+  if (bitmap == NULL) {
+    return NULL;
+  }
+
+  bitmap->row_size_bytes = bitmapRowSize(size.w);
+  bitmap->bounds = GRect(0, 0, size.w, size.h);
+  bitmap->info_flags = BITMAP_OWNS_DATA;
+  bitmap->addr = HostSdkCalloc(1, (size_t) bitmap->row_size_bytes * size.h);
+  if (bitmap->addr == NULL && size.h > 0) {
+    HostSdkFree(bitmap);
+    return NULL;
+  }
+
+  return bitmap;
+}
+
+GBitmap* gbitmap_create_as_sub_bitmap(const GBitmap *base_bitmap, GRect sub_rect) {
+  GBitmap *bitmap = HostSdkCalloc(1, sizeof(GBitmap));
+  if (bitmap == NULL) {
+    return NULL;
+  }
+
+  bitmap->addr = base_bitmap->addr;
+  bitmap->row_size_bytes = base_bitmap->row_size_bytes;
+  bitmap->bounds = intersectRect(GRect(base_bitmap->bounds.origin.x + sub_rect.origin.x,
+                                       base_bitmap->bounds.origin.y + sub_rect.origin.y,
+                                       sub_rect.size.w, sub_rect.size.h), base_bitmap->bounds);
+  return bitmap;
+}
+
+GBitmap* gbitmap_create_with_resource(uint32_t resource_id) {
+  const HostResource *resource = HostGetResource(resource_id);
+  if (resource == NULL) {
+    return NULL;
+  }
+
+  return HostLoadPackedBitmap(resource->data, resource->size);
+}
+
+void gbitmap_destroy(GBitmap *bitmap) {
+  if (bitmap == NULL) {
+    return;
+  }
+
+  if ((bitmap->info_flags & BITMAP_OWNS_DATA) != 0) {
+    HostSdkFree(bitmap->addr);
+  }
+
+  HostSdkFree(bitmap);
+}
+
+const HostResource* HostGetResource(uint32_t resourceId) {
+  if (resourceId == 0 || resourceId >= HostResourceCount) {
+    return NULL;
+  }
+
+  return &HostResources[resourceId];
+}
+
+// Loads a bitmap packed by tools/pack_sprites.py, the format the SDK stores images in on
+// the watch: row size, info flags and bounds followed by the rows. PNGs are still decoded.
+GBitmap* HostLoadPackedBitmap(const uint8_t *data, uint32_t size) {
+  if (size >= 8 && data[0] == 0x89 && memcmp(&data[1], "PNG", 3) == 0) {
+    return HostDecodePng(data, size);
+  }
+
+  if (size < PACKED_BITMAP_HEADER_SIZE) {
+    return NULL;
+  }
+
+  uint16_t rowSize = data[0] | (data[1] << 8);
+  int16_t width = (int16_t) (data[8] | (data[9] << 8));
+  int16_t height = (int16_t) (data[10] | (data[11] << 8));
+  if (width <= 0 || height <= 0 || rowSize != bitmapRowSize(width) ||
+      size < PACKED_BITMAP_HEADER_SIZE + (uint32_t) rowSize * height) {
+    return NULL;
+  }
+
+  GBitmap *bitmap = gbitmap_create_blank(GSize(width, height));
+  if (bitmap == NULL) {
+    return NULL;
+  }
+
+  memcpy(bitmap->addr, &data[PACKED_BITMAP_HEADER_SIZE], (size_t) rowSize * height);
+
+  HostMetrics *metrics = HostGetMetrics();
+  metrics->bitmapsDecoded++;
+  metrics->bitmapBytesDecoded += (uint64_t) rowSize * height;
+  return bitmap;
+}
+
+// Decodes a non-interlaced PNG into a 1-bit bitmap. Pixels at least half bright are white.
+// The inflate buffers come from the app heap, as the firmware's decoder takes them there.
+GBitmap* HostDecodePng(const uint8_t *data, uint32_t size) {
+  static const uint8_t signature[8] = { 0x89, 'P', 'N', 'G', '\r', '\n', 0x1a, '\n' };
+  if (size < sizeof(signature) || memcmp(data, signature, sizeof(signature)) != 0) {
+    return NULL;
+  }
+
+  uint32_t width = 0, height = 0;
+  uint8_t bitDepth = 0, colorType = 0, interlace = 0;
+  uint8_t palette[256 * 3];
+  uint16_t paletteCount = 0;
+  uint8_t *compressed = HostSdkMalloc(size);
+  uLong compressedSize = 0;
+
+  if (compressed == NULL) {
+    return NULL;
+  }
+
+  uint32_t offset = sizeof(signature);
+  while (offset + 12 <= size) {
+    uint32_t length = readBigEndian(&data[offset]);
+    const uint8_t *type = &data[offset + 4];
+    const uint8_t *chunk = &data[offset + 8];
+    if (offset + 12 + length > size) {
+      break;
+    }
+
+    if (memcmp(type, "IHDR", 4) == 0) {
+      width = readBigEndian(chunk);
+      height = readBigEndian(chunk + 4);
+      bitDepth = chunk[8];
+      colorType = chunk[9];
+      interlace = chunk[12];
+
+    } else if (memcmp(type, "PLTE", 4) == 0) {
+      paletteCount = (length / 3 > 256) ? 256 : length / 3;
+      memcpy(palette, chunk, paletteCount * 3);
+
+    } else if (memcmp(type, "IDAT", 4) == 0) {
+      memcpy(&compressed[compressedSize], chunk, length);
+      compressedSize += length;
+
+    } else if (memcmp(type, "IEND", 4) == 0) {
+      break;
+    }
+
+    offset += 12 + length;
+  }
+
+  static const uint8_t channels[7] = { 1, 0, 3, 1, 2, 0, 4 };
+  if (width == 0 || height == 0 || interlace != 0 || colorType > 6 || channels[colorType] == 0) {
+    HostSdkFree(compressed);
+    return NULL;
+  }
+
+  uint32_t bitsPerPixel = channels[colorType] * bitDepth;
+  uint32_t stride = (width * bitsPerPixel + 7) / 8;
+  uint32_t filterBytes = (bitsPerPixel + 7) / 8;
+  uLong rawSize = (stride + 1) * height;
+  uint8_t *raw = HostSdkMalloc(rawSize);
+  if (raw == NULL || uncompress(raw, &rawSize, compressed, compressedSize) != Z_OK) {
+    HostSdkFree(raw);
+    HostSdkFree(compressed);
+    return NULL;
+  }
+
+  HostSdkFree(compressed);
+
+  // Undo the per-row filters in place.
+  for (uint32_t y = 0; y < height; y++) {
+    uint8_t *row = &raw[y * (stride + 1)];
+    uint8_t *previous = (y > 0) ? &raw[(y - 1) * (stride + 1) + 1] : NULL;
+    uint8_t filter = row[0];
+    row++;
+
+    for (uint32_t i = 0; i < stride; i++) {
+      uint8_t a = (i >= filterBytes) ? row[i - filterBytes] : 0;
+      uint8_t b = previous ? previous[i] : 0;
+      uint8_t c = (previous && i >= filterBytes) ? previous[i - filterBytes] : 0;
+
+      switch (filter) {
+        case 1: row[i] += a; break;
+        case 2: row[i] += b; break;
+        case 3: row[i] += (a + b) / 2; break;
+        case 4: row[i] += paeth(a, b, c); break;
+        default: break;
+      }
+    }
+  }
+
+  GBitmap *bitmap = gbitmap_create_blank(GSize(width, height));
+  if (bitmap == NULL) {
+    HostSdkFree(raw);
+    return NULL;
+  }
+
+  uint32_t maxSample = (1 << bitDepth) - 1;
+  for (uint32_t y = 0; y < height; y++) {
+    const uint8_t *row = &raw[y * (stride + 1) + 1];
+
+    for (uint32_t x = 0; x < width; x++) {
+      uint32_t luminance = 0;
+      uint32_t alpha = 255;
+
+      if (bitDepth < 8) {
+        uint32_t bitOffset = x * bitDepth;
+        uint32_t sample = (row[bitOffset / 8] >> (8 - bitDepth - (bitOffset % 8))) & maxSample;
+
+        if (colorType == 3) {
+          uint32_t index = (sample < paletteCount) ? sample : 0;
+          luminance = (palette[index * 3] * 299 + palette[index * 3 + 1] * 587 + palette[index * 3 + 2] * 114) / 1000;
+
+        } else {
+          luminance = sample * 255 / maxSample;
+        }
+      } else {
+        // 8 and 16 bit samples; only the most significant byte matters.
+        uint32_t sampleBytes = bitDepth / 8;
+        const uint8_t *pixel = &row[x * channels[colorType] * sampleBytes];
+
+        switch (colorType) {
+          case 0: luminance = pixel[0]; break;
+          case 2: luminance = (pixel[0] * 299 + pixel[sampleBytes] * 587 + pixel[2 * sampleBytes] * 114) / 1000; break;
+          case 3: luminance = (palette[pixel[0] * 3] * 299 + palette[pixel[0] * 3 + 1] * 587 + palette[pixel[0] * 3 + 2] * 114) / 1000; break;
+          case 4: luminance = pixel[0]; alpha = pixel[sampleBytes]; break;
+          case 6: luminance = (pixel[0] * 299 + pixel[sampleBytes] * 587 + pixel[2 * sampleBytes] * 114) / 1000;
+                  alpha = pixel[3 * sampleBytes]; break;
+          default: break;
+        }
+      }
+
+      // Transparent pixels become white like the background.
+      setPixel(bitmap, x, y, (alpha < 128) || (luminance >= 128));
+    }
+  }
+
+  HostSdkFree(raw);
+
+  HostMetrics *metrics = HostGetMetrics();
+  metrics->bitmapsDecoded++;
+  metrics->bitmapBytesDecoded += (uint64_t) bitmap->row_size_bytes * height;
+  return bitmap;
+}
+
+////////////////////////////////////////////
+// Helpers
+////////////////////////////////////////////
+
+static inline bool getPixel(const GBitmap *bitmap, int16_t x, int16_t y) {
+  const uint8_t *row = (const uint8_t*) bitmap->addr + (y * bitmap->row_size_bytes);
+  return (row[x / 8] >> (x % 8)) & 1;
+}
+
+static inline void setPixel(GBitmap *bitmap, int16_t x, int16_t y, bool white) {
+  uint8_t *row = (uint8_t*) bitmap->addr + (y * bitmap->row_size_bytes);
+  if (white) {
+    row[x / 8] |= (1 << (x % 8));
+
+  } else {
+    row[x / 8] &= ~(1 << (x % 8));
+  }
+}
+
+static inline bool isClipped(GContext *ctx, int16_t x, int16_t y) {
+  return x < ctx->clipBox.origin.x || y < ctx->clipBox.origin.y ||
+         x >= ctx->clipBox.origin.x + ctx->clipBox.size.w || y >= ctx->clipBox.origin.y + ctx->clipBox.size.h;
+}
+
+static void fillPixel(GContext *ctx, int16_t x, int16_t y, GColor color) {
+  if (color == GColorClear || isClipped(ctx, x, y)) {
+    return;
+  }
+
+  HostGetMetrics()->pixelsTouched++;
+  setPixel(&ctx->framebuffer, x, y, color == GColorWhite);
+}
+
+static void compositePixel(GContext *ctx, int16_t x, int16_t y, bool src, GCompOp mode) {
+  if (isClipped(ctx, x, y)) {
+    return;
+  }
+
+  bool dest = getPixel(&ctx->framebuffer, x, y);
+  switch (mode) {
+    case GCompOpAssign: dest = src; break;
+    case GCompOpAssignInverted: dest = !src; break;
+    case GCompOpOr: dest = dest || src; break;
+    case GCompOpAnd: dest = dest && src; break;
+    case GCompOpClear: dest = dest && !src; break;
+    case GCompOpSet: dest = dest || !src; break;
+  }
+
+  HostGetMetrics()->pixelsTouched++;
+  setPixel(&ctx->framebuffer, x, y, dest);
+}
+
+static GRect intersectRect(GRect a, GRect b) {
+  int16_t left = (a.origin.x > b.origin.x) ? a.origin.x : b.origin.x;
+  int16_t top = (a.origin.y > b.origin.y) ? a.origin.y : b.origin.y;
+  int16_t right = ((a.origin.x + a.size.w) < (b.origin.x + b.size.w)) ? (a.origin.x + a.size.w) : (b.origin.x + b.size.w);
+  int16_t bottom = ((a.origin.y + a.size.h) < (b.origin.y + b.size.h)) ? (a.origin.y + a.size.h) : (b.origin.y + b.size.h);
+
+  if (right <= left || bottom <= top) {
+    return GRect(left, top, 0, 0);
+  }
+
+  return GRect(left, top, right - left, bottom - top);
+}
+
+// Rows are padded to whole 32-bit words like the firmware's bitmaps.
+static uint16_t bitmapRowSize(int16_t width) {
+  return ((width + 31) / 32) * 4;
+}
+
+static uint32_t readBigEndian(const uint8_t *data) {
+  return ((uint32_t) data[0] << 24) | ((uint32_t) data[1] << 16) | ((uint32_t) data[2] << 8) | data[3];
+}
+
+static uint8_t paeth(uint8_t a, uint8_t b, uint8_t c) {
+  int16_t p = a + b - c;
+  int16_t pa = abs(p - a);
+  int16_t pb = abs(p - b);
+  int16_t pc = abs(p - c);
+
+  if (pa <= pb && pa <= pc) {
+    return a;
+  }
+
+  return (pb <= pc) ? b : c;
+}
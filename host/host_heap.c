@@ -0,0 +1,112 @@
+#define HOST_RUNTIME
+#include "host.h"
+
+// Size of the app heap on the smallest watch. heap_bytes_free() reports against this.
+#define HOST_APP_HEAP_SIZE (24 * 1024)
+
+// Every block carries a header so that free() can account for its size.
+typedef struct {
+  size_t size;
+  size_t padding;
+} BlockHeader;
+
+static size_t _heapBlocks = 0;
+
+// Defined by the watchface's profiler in PROFILING_ON builds, which then sees every
+// change to the heap instead of the samples it takes on the watch.
+extern void ProfileHeapChanged(size_t used) __attribute__((weak));
+
+static void* heapAlloc(size_t size, bool zero);
+static void heapFree(void *ptr);
+
+void* HostAppMalloc(size_t size) {
+  HostGetMetrics()->appAllocs++;
+  return heapAlloc(size, false);
+}
+
+void* HostAppCalloc(size_t count, size_t size) {
+  HostGetMetrics()->appAllocs++;
+  return heapAlloc(count * size, true);
+}
+
+void* HostAppRealloc(void *ptr, size_t size) {
+  if (ptr == NULL) {
+    return HostAppMalloc(size);
+  }
+
+  BlockHeader *header = ((BlockHeader*) ptr) - 1;
+  void *newPtr = HostAppMalloc(size);
+  if (newPtr != NULL) {
+    memcpy(newPtr, ptr, (header->size < size) ? header->size : size);
+    heapFree(ptr);
+  }
+
+  return newPtr;
+}
+
+void HostAppFree(void *ptr) {
+  heapFree(ptr);
+}
+
+void* HostSdkMalloc(size_t size) {
+  HostGetMetrics()->sdkAllocs++;
+  return heapAlloc(size, false);
+}
+
+void* HostSdkCalloc(size_t count, size_t size) {
+  HostGetMetrics()->sdkAllocs++;
+  return heapAlloc(count * size, true);
+}
+
+void HostSdkFree(void *ptr) {
+  heapFree(ptr);
+}
+
+size_t HostHeapBlocks(void) {
+  return _heapBlocks;
+}
+
+size_t heap_bytes_used(void) {
+  return HostGetMetrics()->heapCurrent;
+}
+
+size_t heap_bytes_free(void) {
+  size_t used = HostGetMetrics()->heapCurrent;
+  return (used < HOST_APP_HEAP_SIZE) ? (HOST_APP_HEAP_SIZE - used) : 0;
+}
+
+static void* heapAlloc(size_t size, bool zero) {
+  BlockHeader *header = zero ? calloc(1, sizeof(BlockHeader) + size) : malloc(sizeof(BlockHeader) + size);
+  if (header == NULL) {
+    return NULL;
+  }
+
+  HostMetrics *metrics = HostGetMetrics();
+  header->size = size;
+  metrics->heapCurrent += size;
+  if (metrics->heapCurrent > metrics->heapPeak) {
+    metrics->heapPeak = metrics->heapCurrent;
+  }
+
+  _heapBlocks++;
+  if (ProfileHeapChanged != NULL) {
+    ProfileHeapChanged(metrics->heapCurrent);
+  }
+
+  return header + 1;
+}
+
+static void heapFree(void *ptr) {
+  if (ptr == NULL) {
+    return;
+  }
+
+  BlockHeader *header = ((BlockHeader*) ptr) - 1;
+  HostGetMetrics()->heapCurrent -= header->size;
+  _heapBlocks--;
+  free(header);
+
+  if (ProfileHeapChanged != NULL) {
+    ProfileHeapChanged(HostGetMetrics()->heapCurrent);
+  }
+}
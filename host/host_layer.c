@@ -0,0 +1,684 @@
+#define HOST_RUNTIME
+#include "host.h"
+
+struct Window {
+  Layer rootLayer;
+  WindowHandlers handlers;
+  GColor backgroundColor;
+  bool loaded;
+  bool onStack;
+};
+
+static Window *_topWindow = NULL;
+static bool _dirty = false;
+static GRect _dirtyRect;
+
+static void initLayer(Layer *layer, GRect frame);
+static void markDirtyRect(GRect rect);
+static GRect getScreenFrame(const Layer *layer);
+static void renderLayer(Layer *layer, GContext *ctx, GPoint parentOrigin, GRect parentClip);
+static void bitmapLayerUpdateProc(Layer *layer, GContext *ctx);
+static void rotBitmapLayerUpdateProc(Layer *layer, GContext *ctx);
+static void inverterLayerUpdateProc(Layer *layer, GContext *ctx);
+static void textLayerUpdateProc(Layer *layer, GContext *ctx);
+static GRect intersectRect(GRect a, GRect b);
+static int16_t squareRoot(int32_t value);
+
+////////////////////////////////////////////
+// Rendering
+////////////////////////////////////////////
+
+void HostMarkDirty(void) {
+  markDirtyRect(GRect(0, 0, HOST_SCREEN_WIDTH, HOST_SCREEN_HEIGHT));
+}
+
+bool HostIsDirty(void) {
+  return _dirty;
+}
+
+// Redraws the whole layer tree of the top window, as the firmware does whenever any
+// layer in it has been marked dirty. The area that was invalidated is still recorded, as
+// it is all the app asked to have redrawn.
+void HostRender(void) {
+  HostGetMetrics()->dirtyPixels += (uint64_t) _dirtyRect.size.w * _dirtyRect.size.h;
+  _dirty = false;
+  _dirtyRect = GRectZero;
+  if (_topWindow == NULL || _topWindow->loaded == false) {
+    return;
+  }
+
+  uint64_t startNs = HostCpuNs();
+  GContext *ctx = HostGraphicsContext();
+  GBitmap *framebuffer = HostFramebuffer();
+  memset(framebuffer->addr, (_topWindow->backgroundColor == GColorBlack) ? 0x00 : 0xff,
+         framebuffer->row_size_bytes * HOST_SCREEN_HEIGHT);
+
+  renderLayer(&_topWindow->rootLayer, ctx, GPointZero, GRect(0, 0, HOST_SCREEN_WIDTH, HOST_SCREEN_HEIGHT));
+
+  HostMetrics *metrics = HostGetMetrics();
+  metrics->framesRendered++;
+  metrics->renderCpuNs += HostCpuNs() - startNs;
+}
+
+void HostRenderLayer(Layer *layer, GContext *ctx) {
+  if (layer->update_proc != NULL) {
+    HostGetMetrics()->updateProcCalls++;
+    layer->update_proc(layer, ctx);
+  }
+}
+
+static void renderLayer(Layer *layer, GContext *ctx, GPoint parentOrigin, GRect parentClip) {
+  if (layer->hidden) {
+    return;
+  }
+
+  GRect frame = GRect(parentOrigin.x + layer->frame.origin.x, parentOrigin.y + layer->frame.origin.y,
+                      layer->frame.size.w, layer->frame.size.h);
+  GRect clip = layer->clips ? intersectRect(parentClip, frame) : parentClip;
+  GRect drawingBox = GRect(frame.origin.x + layer->bounds.origin.x, frame.origin.y + layer->bounds.origin.y,
+                           layer->bounds.size.w, layer->bounds.size.h);
+
+  if (clip.size.w > 0 && clip.size.h > 0) {
+    HostContextReset(ctx);
+    HostContextSetDrawingBox(ctx, drawingBox, clip);
+    HostRenderLayer(layer, ctx);
+  }
+
+  for (Layer *child = layer->first_child; child != NULL; child = child->next_sibling) {
+    renderLayer(child, ctx, drawingBox.origin, clip);
+  }
+}
+
+////////////////////////////////////////////
+// Layer
+////////////////////////////////////////////
+
+Layer* layer_create(GRect frame) {
+  Layer *layer = HostSdkCalloc(1, sizeof(Layer));
+  if (layer != NULL) {
+    initLayer(layer, frame);
+  }
+
+  return layer;
+}
+
+Layer* layer_create_with_data(GRect frame, size_t data_size) {
+  Layer *layer = HostSdkCalloc(1, sizeof(Layer) + data_size);
+  if (layer != NULL) {
+    initLayer(layer, frame);
+    layer->data = layer + 1;
+  }
+
+  return layer;
+}
+
+void layer_destroy(Layer *layer) {
+  if (layer == NULL) {
+    return;
+  }
+
+  layer_remove_from_parent(layer);
+  layer_remove_child_layers(layer);
+  HostSdkFree(layer);
+}
+
+void* layer_get_data(const Layer *layer) {
+  return layer->data;
+}
+
+void layer_mark_dirty(Layer *layer) {
+  markDirtyRect(getScreenFrame(layer));
+}
+
+void layer_set_update_proc(Layer *layer, LayerUpdateProc update_proc) {
+  layer->update_proc = update_proc;
+  layer_mark_dirty(layer);
+}
+
+void layer_set_frame(Layer *layer, GRect frame) {
+  if (grect_equal(&layer->frame, &frame)) {
+    return;
+  }
+
+  // Keep the bounds in step with the frame size like the firmware does.
+  if (layer->bounds.size.w == layer->frame.size.w && layer->bounds.size.h == layer->frame.size.h) {
+    layer->bounds.size = frame.size;
+  }
+
+  // Both where the layer was and where it is now need redrawing.
+  layer_mark_dirty(layer);
+  layer->frame = frame;
+  layer_mark_dirty(layer);
+}
+
+GRect layer_get_frame(const Layer *layer) {
+  return layer->frame;
+}
+
+void layer_set_bounds(Layer *layer, GRect bounds) {
+  if (grect_equal(&layer->bounds, &bounds)) {
+    return;
+  }
+
+  layer->bounds = bounds;
+  layer_mark_dirty(layer);
+}
+
+GRect layer_get_bounds(const Layer *layer) {
+  return layer->bounds;
+}
+
+struct Window* layer_get_window(const Layer *layer) {
+  return layer->window;
+}
+
+void layer_remove_from_parent(Layer *child) {
+  Layer *parent = child->parent;
+  if (parent == NULL) {
+    return;
+  }
+
+  if (parent->first_child == child) {
+    parent->first_child = child->next_sibling;
+
+  } else {
+    for (Layer *sibling = parent->first_child; sibling != NULL; sibling = sibling->next_sibling) {
+      if (sibling->next_sibling == child) {
+        sibling->next_sibling = child->next_sibling;
+        break;
+      }
+    }
+  }
+
+  layer_mark_dirty(child);
+  child->parent = NULL;
+  child->next_sibling = NULL;
+  child->window = NULL;
+}
+
+void layer_remove_child_layers(Layer *parent) {
+  while (parent->first_child != NULL) {
+    layer_remove_from_parent(parent->first_child);
+  }
+}
+
+void layer_add_child(Layer *parent, Layer *child) {
+  layer_remove_from_parent(child);
+  child->parent = parent;
+  child->window = parent->window;
+
+  if (parent->first_child == NULL) {
+    parent->first_child = child;
+
+  } else {
+    Layer *last = parent->first_child;
+    while (last->next_sibling != NULL) {
+      last = last->next_sibling;
+    }
+
+    last->next_sibling = child;
+  }
+
+  layer_mark_dirty(child);
+}
+
+void layer_insert_below_sibling(Layer *layer_to_insert, Layer *below_sibling_layer) {
+  Layer *parent = below_sibling_layer->parent;
+  if (parent == NULL) {
+    return;
+  }
+
+  layer_remove_from_parent(layer_to_insert);
+  layer_to_insert->parent = parent;
+  layer_to_insert->window = parent->window;
+  layer_to_insert->next_sibling = below_sibling_layer;
+
+  if (parent->first_child == below_sibling_layer) {
+    parent->first_child = layer_to_insert;
+
+  } else {
+    for (Layer *sibling = parent->first_child; sibling != NULL; sibling = sibling->next_sibling) {
+      if (sibling->next_sibling == below_sibling_layer) {
+        sibling->next_sibling = layer_to_insert;
+        break;
+      }
+    }
+  }
+
+  layer_mark_dirty(layer_to_insert);
+}
+
+void layer_insert_above_sibling(Layer *layer_to_insert, Layer *above_sibling_layer) {
+  Layer *parent = above_sibling_layer->parent;
+  if (parent == NULL) {
+    return;
+  }
+
+  layer_remove_from_parent(layer_to_insert);
+  layer_to_insert->parent = parent;
+  layer_to_insert->window = parent->window;
+  layer_to_insert->next_sibling = above_sibling_layer->next_sibling;
+  above_sibling_layer->next_sibling = layer_to_insert;
+  layer_mark_dirty(layer_to_insert);
+}
+
+void layer_set_hidden(Layer *layer, bool hidden) {
+  if (layer->hidden != hidden) {
+    layer->hidden = hidden;
+    layer_mark_dirty(layer);
+  }
+}
+
+bool layer_get_hidden(const Layer *layer) {
+  return layer->hidden;
+}
+
+void layer_set_clips(Layer *layer, bool clips) {
+  layer->clips = clips;
+  layer_mark_dirty(layer);
+}
+
+bool layer_get_clips(const Layer *layer) {
+  return layer->clips;
+}
+
+// Grows the invalidated area to the bounding box of it and rect, clipped to the screen.
+static void markDirtyRect(GRect rect) {
+  _dirty = true;
+  rect = intersectRect(rect, GRect(0, 0, HOST_SCREEN_WIDTH, HOST_SCREEN_HEIGHT));
+  if (rect.size.w <= 0 || rect.size.h <= 0) {
+    return;
+  }
+
+  if (_dirtyRect.size.w <= 0 || _dirtyRect.size.h <= 0) {
+    _dirtyRect = rect;
+    return;
+  }
+
+  int16_t left = (rect.origin.x < _dirtyRect.origin.x) ? rect.origin.x : _dirtyRect.origin.x;
+  int16_t top = (rect.origin.y < _dirtyRect.origin.y) ? rect.origin.y : _dirtyRect.origin.y;
+  int16_t right = rect.origin.x + rect.size.w;
+  int16_t bottom = rect.origin.y + rect.size.h;
+  if (_dirtyRect.origin.x + _dirtyRect.size.w > right) {
+    right = _dirtyRect.origin.x + _dirtyRect.size.w;
+  }
+
+  if (_dirtyRect.origin.y + _dirtyRect.size.h > bottom) {
+    bottom = _dirtyRect.origin.y + _dirtyRect.size.h;
+  }
+
+  _dirtyRect = GRect(left, top, right - left, bottom - top);
+}
+
+// The layer's frame in screen coordinates, following the parents' frames and bounds.
+static GRect getScreenFrame(const Layer *layer) {
+  GRect frame = layer->frame;
+  for (const Layer *parent = layer->parent; parent != NULL; parent = parent->parent) {
+    frame.origin.x += parent->frame.origin.x + parent->bounds.origin.x;
+    frame.origin.y += parent->frame.origin.y + parent->bounds.origin.y;
+  }
+
+  return frame;
+}
+
+static void initLayer(Layer *layer, GRect frame) {
+  layer->frame = frame;
+  layer->bounds = GRect(0, 0, frame.size.w, frame.size.h);
+  layer->clips = true;
+}
+
+////////////////////////////////////////////
+// BitmapLayer
+////////////////////////////////////////////
+
+BitmapLayer* bitmap_layer_create(GRect frame) {
+  BitmapLayer *bitmapLayer = HostSdkCalloc(1, sizeof(BitmapLayer));
+  if (bitmapLayer != NULL) {
+    initLayer(&bitmapLayer->layer, frame);
+    bitmapLayer->layer.update_proc = bitmapLayerUpdateProc;
+    bitmapLayer->background_color = GColorClear;
+    bitmapLayer->alignment = GAlignCenter;
+    bitmapLayer->compositing_mode = GCompOpAssign;
+  }
+
+  return bitmapLayer;
+}
+
+void bitmap_layer_destroy(BitmapLayer *bitmap_layer) {
+  layer_destroy((Layer*) bitmap_layer);
+}
+
+Layer* bitmap_layer_get_layer(const BitmapLayer *bitmap_layer) {
+  return (Layer*) &bitmap_layer->layer;
+}
+
+const GBitmap* bitmap_layer_get_bitmap(BitmapLayer *bitmap_layer) {
+  return bitmap_layer->bitmap;
+}
+
+void bitmap_layer_set_bitmap(BitmapLayer *bitmap_layer, const GBitmap *bitmap) {
+  bitmap_layer->bitmap = bitmap;
+  layer_mark_dirty(&bitmap_layer->layer);
+}
+
+void bitmap_layer_set_alignment(BitmapLayer *bitmap_layer, GAlign alignment) {
+  bitmap_layer->alignment = alignment;
+  layer_mark_dirty(&bitmap_layer->layer);
+}
+
+void bitmap_layer_set_background_color(BitmapLayer *bitmap_layer, GColor color) {
+  bitmap_layer->background_color = color;
+  layer_mark_dirty(&bitmap_layer->layer);
+}
+
+void bitmap_layer_set_compositing_mode(BitmapLayer *bitmap_layer, GCompOp mode) {
+  bitmap_layer->compositing_mode = mode;
+  layer_mark_dirty(&bitmap_layer->layer);
+}
+
+static void bitmapLayerUpdateProc(Layer *layer, GContext *ctx) {
+  BitmapLayer *bitmapLayer = (BitmapLayer*) layer;
+  GRect bounds = GRect(0, 0, layer->bounds.size.w, layer->bounds.size.h);
+
+  if (bitmapLayer->background_color != GColorClear) {
+    graphics_context_set_fill_color(ctx, bitmapLayer->background_color);
+    graphics_fill_rect(ctx, bounds, 0, GCornerNone);
+  }
+
+  if (bitmapLayer->bitmap == NULL) {
+    return;
+  }
+
+  GSize size = bitmapLayer->bitmap->bounds.size;
+  GRect rect = GRect(0, 0, size.w, size.h);
+
+  switch (bitmapLayer->alignment) {
+    case GAlignTopLeft: break;
+    case GAlignTop: rect.origin.x = (bounds.size.w - size.w) / 2; break;
+    case GAlignTopRight: rect.origin.x = bounds.size.w - size.w; break;
+    case GAlignLeft: rect.origin.y = (bounds.size.h - size.h) / 2; break;
+    case GAlignRight: rect.origin = GPoint(bounds.size.w - size.w, (bounds.size.h - size.h) / 2); break;
+    case GAlignBottomLeft: rect.origin.y = bounds.size.h - size.h; break;
+    case GAlignBottom: rect.origin = GPoint((bounds.size.w - size.w) / 2, bounds.size.h - size.h); break;
+    case GAlignBottomRight: rect.origin = GPoint(bounds.size.w - size.w, bounds.size.h - size.h); break;
+    default: rect.origin = GPoint((bounds.size.w - size.w) / 2, (bounds.size.h - size.h) / 2); break;
+  }
+
+  graphics_context_set_compositing_mode(ctx, bitmapLayer->compositing_mode);
+  graphics_draw_bitmap_in_rect(ctx, bitmapLayer->bitmap, rect);
+}
+
+////////////////////////////////////////////
+// RotBitmapLayer
+////////////////////////////////////////////
+
+RotBitmapLayer* rot_bitmap_layer_create(GBitmap *bitmap) {
+  RotBitmapLayer *rotLayer = HostSdkCalloc(1, sizeof(RotBitmapLayer));
+  if (rotLayer != NULL) {
+    // The frame is large enough to hold the bitmap at any angle.
+    int16_t hypotenuse = squareRoot(bitmap->bounds.size.w * bitmap->bounds.size.w +
+                                    bitmap->bounds.size.h * bitmap->bounds.size.h);
+    initLayer(&rotLayer->layer, GRect(0, 0, hypotenuse, hypotenuse));
+    rotLayer->layer.update_proc = rotBitmapLayerUpdateProc;
+    rotLayer->bitmap = bitmap;
+    rotLayer->corner_clip_color = GColorClear;
+    rotLayer->src_ic = GPoint(bitmap->bounds.size.w / 2, bitmap->bounds.size.h / 2);
+    rotLayer->dest_ic = GPoint(hypotenuse / 2, hypotenuse / 2);
+    rotLayer->compositing_mode = GCompOpAssign;
+  }
+
+  return rotLayer;
+}
+
+void rot_bitmap_layer_destroy(RotBitmapLayer *bitmap) {
+  layer_destroy((Layer*) bitmap);
+}
+
+void rot_bitmap_layer_set_corner_clip_color(RotBitmapLayer *bitmap, GColor color) {
+  bitmap->corner_clip_color = color;
+  layer_mark_dirty(&bitmap->layer);
+}
+
+void rot_bitmap_layer_set_angle(RotBitmapLayer *bitmap, int32_t angle) {
+  bitmap->rotation = angle % TRIG_MAX_ANGLE;
+  layer_mark_dirty(&bitmap->layer);
+}
+
+void rot_bitmap_layer_increment_angle(RotBitmapLayer *bitmap, int32_t angle_change) {
+  rot_bitmap_layer_set_angle(bitmap, bitmap->rotation + angle_change);
+}
+
+void rot_bitmap_set_src_ic(RotBitmapLayer *bitmap, GPoint ic) {
+  bitmap->src_ic = ic;
+  layer_mark_dirty(&bitmap->layer);
+}
+
+void rot_bitmap_set_compositing_mode(RotBitmapLayer *bitmap, GCompOp mode) {
+  bitmap->compositing_mode = mode;
+  layer_mark_dirty(&bitmap->layer);
+}
+
+static void rotBitmapLayerUpdateProc(Layer *layer, GContext *ctx) {
+  RotBitmapLayer *rotLayer = (RotBitmapLayer*) layer;
+
+  if (rotLayer->corner_clip_color != GColorClear) {
+    graphics_context_set_fill_color(ctx, rotLayer->corner_clip_color);
+    graphics_fill_rect(ctx, GRect(0, 0, layer->bounds.size.w, layer->bounds.size.h), 0, GCornerNone);
+  }
+
+  // The bitmap rotates about the center of the layer, whatever its current size.
+  GPoint destCenter = GPoint(layer->bounds.size.w / 2, layer->bounds.size.h / 2);
+  HostDrawRotatedBitmap(ctx, rotLayer->bitmap, rotLayer->src_ic, destCenter, rotLayer->rotation,
+                        rotLayer->compositing_mode);
+}
+
+////////////////////////////////////////////
+// InverterLayer
+////////////////////////////////////////////
+
+InverterLayer* inverter_layer_create(GRect frame) {
+  InverterLayer *inverterLayer = HostSdkCalloc(1, sizeof(InverterLayer));
+  if (inverterLayer != NULL) {
+    initLayer(&inverterLayer->layer, frame);
+    inverterLayer->layer.update_proc = inverterLayerUpdateProc;
+  }
+
+  return inverterLayer;
+}
+
+void inverter_layer_destroy(InverterLayer *inverter_layer) {
+  layer_destroy((Layer*) inverter_layer);
+}
+
+Layer* inverter_layer_get_layer(InverterLayer *inverter_layer) {
+  return &inverter_layer->layer;
+}
+
+static void inverterLayerUpdateProc(Layer *layer, GContext *ctx) {
+  HostInvertRect(ctx, GRect(0, 0, layer->bounds.size.w, layer->bounds.size.h));
+}
+
+////////////////////////////////////////////
+// TextLayer
+////////////////////////////////////////////
+
+TextLayer* text_layer_create(GRect frame) {
+  TextLayer *textLayer = HostSdkCalloc(1, sizeof(TextLayer));
+  if (textLayer != NULL) {
+    initLayer(&textLayer->layer, frame);
+    textLayer->layer.update_proc = textLayerUpdateProc;
+    textLayer->font = fonts_get_system_font(FONT_KEY_GOTHIC_14_BOLD);
+    textLayer->text_color = GColorBlack;
+    textLayer->background_color = GColorWhite;
+    textLayer->overflow_mode = GTextOverflowModeWordWrap;
+    textLayer->text_alignment = GTextAlignmentLeft;
+  }
+
+  return textLayer;
+}
+
+void text_layer_destroy(TextLayer *text_layer) {
+  layer_destroy((Layer*) text_layer);
+}
+
+Layer* text_layer_get_layer(TextLayer *text_layer) {
+  return &text_layer->layer;
+}
+
+void text_layer_set_text(TextLayer *text_layer, const char *text) {
+  text_layer->text = text;
+  layer_mark_dirty(&text_layer->layer);
+}
+
+const char* text_layer_get_text(TextLayer *text_layer) {
+  return text_layer->text;
+}
+
+void text_layer_set_background_color(TextLayer *text_layer, GColor color) {
+  text_layer->background_color = color;
+  layer_mark_dirty(&text_layer->layer);
+}
+
+void text_layer_set_text_color(TextLayer *text_layer, GColor color) {
+  text_layer->text_color = color;
+  layer_mark_dirty(&text_layer->layer);
+}
+
+void text_layer_set_overflow_mode(TextLayer *text_layer, GTextOverflowMode line_mode) {
+  text_layer->overflow_mode = line_mode;
+  layer_mark_dirty(&text_layer->layer);
+}
+
+void text_layer_set_font(TextLayer *text_layer, GFont font) {
+  text_layer->font = font;
+  layer_mark_dirty(&text_layer->layer);
+}
+
+void text_layer_set_text_alignment(TextLayer *text_layer, GTextAlignment text_alignment) {
+  text_layer->text_alignment = text_alignment;
+  layer_mark_dirty(&text_layer->layer);
+}
+
+static void textLayerUpdateProc(Layer *layer, GContext *ctx) {
+  TextLayer *textLayer = (TextLayer*) layer;
+  GRect bounds = GRect(0, 0, layer->bounds.size.w, layer->bounds.size.h);
+
+  if (textLayer->background_color != GColorClear) {
+    graphics_context_set_fill_color(ctx, textLayer->background_color);
+    graphics_fill_rect(ctx, bounds, 0, GCornerNone);
+  }
+
+  graphics_context_set_text_color(ctx, textLayer->text_color);
+  graphics_draw_text(ctx, textLayer->text, textLayer->font, bounds, textLayer->overflow_mode,
+                     textLayer->text_alignment, NULL);
+}
+
+////////////////////////////////////////////
+// Window
+////////////////////////////////////////////
+
+Window* window_create(void) {
+  Window *window = HostSdkCalloc(1, sizeof(Window));
+  if (window != NULL) {
+    initLayer(&window->rootLayer, GRect(0, 0, HOST_SCREEN_WIDTH, HOST_SCREEN_HEIGHT));
+    window->rootLayer.window = window;
+    window->backgroundColor = GColorWhite;
+  }
+
+  return window;
+}
+
+void window_destroy(Window *window) {
+  if (window == NULL) {
+    return;
+  }
+
+  if (window->onStack) {
+    if (window->handlers.disappear != NULL) {
+      window->handlers.disappear(window);
+    }
+
+    window->onStack = false;
+    if (_topWindow == window) {
+      _topWindow = NULL;
+    }
+  }
+
+  if (window->loaded && window->handlers.unload != NULL) {
+    window->handlers.unload(window);
+  }
+
+  layer_remove_child_layers(&window->rootLayer);
+  HostSdkFree(window);
+}
+
+void window_set_window_handlers(Window *window, WindowHandlers handlers) {
+  window->handlers = handlers;
+}
+
+Layer* window_get_root_layer(const Window *window) {
+  return (Layer*) &window->rootLayer;
+}
+
+void window_set_background_color(Window *window, GColor background_color) {
+  window->backgroundColor = background_color;
+  HostMarkDirty();
+}
+
+void window_stack_push(Window *window, bool animated) {
+  _topWindow = window;
+  window->onStack = true;
+
+  if (window->loaded == false) {
+    window->loaded = true;
+    if (window->handlers.load != NULL) {
+      window->handlers.load(window);
+    }
+  }
+
+  if (window->handlers.appear != NULL) {
+    window->handlers.appear(window);
+  }
+
+  HostMarkDirty();
+}
+
+Window* window_stack_pop(bool animated) {
+  Window *window = _topWindow;
+  if (window != NULL) {
+    if (window->handlers.disappear != NULL) {
+      window->handlers.disappear(window);
+    }
+
+    window->onStack = false;
+    _topWindow = NULL;
+  }
+
+  return window;
+}
+
+////////////////////////////////////////////
+// Helpers
+////////////////////////////////////////////
+
+static GRect intersectRect(GRect a, GRect b) {
+  int16_t left = (a.origin.x > b.origin.x) ? a.origin.x : b.origin.x;
+  int16_t top = (a.origin.y > b.origin.y) ? a.origin.y : b.origin.y;
+  int16_t right = ((a.origin.x + a.size.w) < (b.origin.x + b.size.w)) ? (a.origin.x + a.size.w) : (b.origin.x + b.size.w);
+  int16_t bottom = ((a.origin.y + a.size.h) < (b.origin.y + b.size.h)) ? (a.origin.y + a.size.h) : (b.origin.y + b.size.h);
+
+  if (right <= left || bottom <= top) {
+    return GRect(left, top, 0, 0);
+  }
+
+  return GRect(left, top, right - left, bottom - top);
+}
+
+static int16_t squareRoot(int32_t value) {
+  int32_t root = 0;
+  while ((root + 1) * (root + 1) <= value) {
+    root++;
+  }
+
+  return root;
+}
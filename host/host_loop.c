@@ -0,0 +1,502 @@
+#define _GNU_SOURCE
+#define HOST_RUNTIME
+#include "host.h"
+#include <stdarg.h>
+
+// Default launch time when HOST_START is not given: Thursday, Jan 1 2015 00:00:00 UTC.
+#define DEFAULT_START_TIME 1420070400
+#define DEFAULT_DURATION_SECONDS 3600
+
+struct AppTimer {
+  struct AppTimer *next;
+  uint64_t due;
+  AppTimerCallback callback;
+  void *data;
+};
+
+static HostConfig _config;
+static bool _configLoaded = false;
+static HostMetrics _metrics;
+static uint64_t _nowMs = 0;
+static uint64_t _startupCpuNs = 0;
+static struct tm _localTime;
+
+static AppTimer *_timers = NULL;
+static TimeUnits _tickUnits = 0;
+static TickHandler _tickHandler = NULL;
+static struct tm _lastTick;
+static AccelTapHandler _tapHandler = NULL;
+static BatteryStateHandler _batteryHandler = NULL;
+static BluetoothConnectionHandler _bluetoothHandler = NULL;
+
+static void loadConfig(void);
+static time_t parseTime(const char *text);
+static void parseTaps(HostConfig *config, const char *text);
+static int64_t nextTickDue(void);
+static void runTick(void);
+static void reportAtExit(void);
+static uint64_t minDue(uint64_t current, int64_t due);
+
+__attribute__((constructor)) static void recordLaunch(void) {
+  _startupCpuNs = HostCpuNs();
+}
+
+////////////////////////////////////////////
+// Config and metrics
+////////////////////////////////////////////
+
+HostConfig* HostGetConfig(void) {
+  loadConfig();
+  return &_config;
+}
+
+HostMetrics* HostGetMetrics(void) {
+  return &_metrics;
+}
+
+uint64_t HostNowMs(void) {
+  return _nowMs;
+}
+
+uint64_t HostCpuNs(void) {
+  struct timespec now;
+  clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &now);
+  return (uint64_t) now.tv_sec * 1000000000ULL + now.tv_nsec;
+}
+
+void HostLoadConfigFromEnvironment(HostConfig *config) {
+  memset(config, 0, sizeof(HostConfig));
+  config->startTime = DEFAULT_START_TIME;
+  config->durationSeconds = DEFAULT_DURATION_SECONDS;
+  config->batteryPercent = 80;
+  config->bluetoothConnected = true;
+
+  const char *value;
+  if ((value = getenv("HOST_START")) != NULL) {
+    config->startTime = parseTime(value);
+  }
+
+  if ((value = getenv("HOST_DURATION")) != NULL) {
+    config->durationSeconds = strtoul(value, NULL, 10);
+  }
+
+  if ((value = getenv("HOST_TAPS")) != NULL) {
+    parseTaps(config, value);
+  }
+
+  if ((value = getenv("HOST_BATTERY")) != NULL) {
+    config->batteryPercent = atoi(value);
+  }
+
+  if ((value = getenv("HOST_CHARGING")) != NULL) {
+    config->batteryCharging = (atoi(value) != 0);
+  }
+
+  if ((value = getenv("HOST_24H")) != NULL) {
+    config->clock24Hour = (atoi(value) != 0);
+  }
+
+  if ((value = getenv("HOST_BLUETOOTH")) != NULL) {
+    config->bluetoothConnected = (atoi(value) != 0);
+  }
+
+  if ((value = getenv("HOST_LOG")) != NULL) {
+    config->logging = (atoi(value) != 0);
+  }
+
+  config->framebufferPath = getenv("HOST_FRAMEBUFFER");
+}
+
+void HostPrintReport(FILE *out) {
+  fprintf(out, "simulated_ms=%llu\n", (unsigned long long) _metrics.simulatedMs);
+  fprintf(out, "wakeups=%u\n", _metrics.wakeups);
+  fprintf(out, "tick_events=%u\n", _metrics.tickEvents);
+  fprintf(out, "tap_events=%u\n", _metrics.tapEvents);
+  fprintf(out, "timers_registered=%u\n", _metrics.timersRegistered);
+  fprintf(out, "timers_fired=%u\n", _metrics.timersFired);
+  fprintf(out, "animations_scheduled=%u\n", _metrics.animationsScheduled);
+  fprintf(out, "animation_frames=%u\n", _metrics.animationFrames);
+  fprintf(out, "frames_rendered=%u\n", _metrics.framesRendered);
+  fprintf(out, "update_proc_calls=%u\n", _metrics.updateProcCalls);
+  fprintf(out, "pixel_ops=%llu\n", (unsigned long long) _metrics.pixelsTouched);
+  fprintf(out, "dirty_pixels=%llu\n", (unsigned long long) _metrics.dirtyPixels);
+  fprintf(out, "bitmaps_decoded=%u\n", _metrics.bitmapsDecoded);
+  fprintf(out, "bitmap_bytes_decoded=%llu\n", (unsigned long long) _metrics.bitmapBytesDecoded);
+  fprintf(out, "heap_current=%zu\n", _metrics.heapCurrent);
+  fprintf(out, "heap_peak=%zu\n", _metrics.heapPeak);
+  fprintf(out, "heap_blocks=%zu\n", HostHeapBlocks());
+  fprintf(out, "app_allocs=%u\n", _metrics.appAllocs);
+  fprintf(out, "sdk_allocs=%u\n", _metrics.sdkAllocs);
+  fprintf(out, "tick_app_allocs=%u\n", _metrics.tickAppAllocs);
+  fprintf(out, "persist_reads=%u\n", _metrics.persistReads);
+  fprintf(out, "persist_writes=%u\n", _metrics.persistWrites);
+  fprintf(out, "persist_bytes_written=%u\n", _metrics.persistBytesWritten);
+  fprintf(out, "app_message_inbox=%u\n", _metrics.appMessageInboxSize);
+  fprintf(out, "app_message_outbox=%u\n", _metrics.appMessageOutboxSize);
+  fprintf(out, "startup_cpu_ns=%llu\n", (unsigned long long) _startupCpuNs);
+  fprintf(out, "callback_cpu_ns=%llu\n", (unsigned long long) _metrics.callbackCpuNs);
+  fprintf(out, "render_cpu_ns=%llu\n", (unsigned long long) _metrics.renderCpuNs);
+}
+
+static void loadConfig(void) {
+  if (_configLoaded == false) {
+    _configLoaded = true;
+    HostLoadConfigFromEnvironment(&_config);
+  }
+}
+
+static time_t parseTime(const char *text) {
+  struct tm parsed;
+  memset(&parsed, 0, sizeof(parsed));
+
+  if (strptime(text, "%Y-%m-%d %H:%M:%S", &parsed) != NULL || strptime(text, "%Y-%m-%d %H:%M", &parsed) != NULL) {
+    return timegm(&parsed);
+  }
+
+  return (time_t) strtoll(text, NULL, 10);
+}
+
+static void parseTaps(HostConfig *config, const char *text) {
+  char *end = NULL;
+  while (*text != '\0' && config->tapCount < HOST_MAX_TAPS) {
+    unsigned long second = strtoul(text, &end, 10);
+    if (end == text) {
+      break;
+    }
+
+    config->tapSeconds[config->tapCount++] = second;
+    text = (*end == ',') ? end + 1 : end;
+  }
+}
+
+////////////////////////////////////////////
+// Clock
+////////////////////////////////////////////
+
+time_t HostTime(time_t *tloc) {
+  time_t now = HostGetConfig()->startTime + (time_t) (_nowMs / 1000);
+  if (tloc != NULL) {
+    *tloc = now;
+  }
+
+  return now;
+}
+
+// The watch keeps local time; the host treats the virtual clock as local time.
+struct tm* HostLocaltime(const time_t *timep) {
+  return gmtime_r(timep, &_localTime);
+}
+
+uint16_t time_ms(time_t *tloc, uint16_t *out_ms) {
+  uint16_t ms = (uint16_t) (_nowMs % 1000);
+  HostTime(tloc);
+  if (out_ms != NULL) {
+    *out_ms = ms;
+  }
+
+  return ms;
+}
+
+bool clock_is_24h_style(void) {
+  return HostGetConfig()->clock24Hour;
+}
+
+////////////////////////////////////////////
+// Timers
+////////////////////////////////////////////
+
+AppTimer* app_timer_register(uint32_t timeout_ms, AppTimerCallback callback, void *callback_data) {
+  AppTimer *timer = HostSdkMalloc(sizeof(AppTimer));
+  if (timer == NULL) {
+    return NULL;
+  }
+
+  timer->due = _nowMs + timeout_ms;
+  timer->callback = callback;
+  timer->data = callback_data;
+  timer->next = _timers;
+  _timers = timer;
+  _metrics.timersRegistered++;
+  return timer;
+}
+
+bool app_timer_reschedule(AppTimer *timer_handle, uint32_t new_timeout_ms) {
+  for (AppTimer *timer = _timers; timer != NULL; timer = timer->next) {
+    if (timer == timer_handle) {
+      timer->due = _nowMs + new_timeout_ms;
+      return true;
+    }
+  }
+
+  return false;
+}
+
+void app_timer_cancel(AppTimer *timer_handle) {
+  for (AppTimer **link = &_timers; *link != NULL; link = &(*link)->next) {
+    if (*link == timer_handle) {
+      *link = timer_handle->next;
+      HostSdkFree(timer_handle);
+      return;
+    }
+  }
+}
+
+int64_t HostTimerNextDue(void) {
+  int64_t due = -1;
+  for (AppTimer *timer = _timers; timer != NULL; timer = timer->next) {
+    if (due < 0 || (int64_t) timer->due < due) {
+      due = timer->due;
+    }
+  }
+
+  return due;
+}
+
+// Fires every timer due at or before now, earliest first.
+void HostTimerRunDue(uint64_t now) {
+  while (true) {
+    AppTimer **earliest = NULL;
+    for (AppTimer **link = &_timers; *link != NULL; link = &(*link)->next) {
+      if ((*link)->due <= now && (earliest == NULL || (*link)->due < (*earliest)->due)) {
+        earliest = link;
+      }
+    }
+
+    if (earliest == NULL) {
+      return;
+    }
+
+    AppTimer *timer = *earliest;
+    *earliest = timer->next;
+    AppTimerCallback callback = timer->callback;
+    void *data = timer->data;
+    HostSdkFree(timer);
+
+    _metrics.timersFired++;
+    callback(data);
+  }
+}
+
+////////////////////////////////////////////
+// Services
+////////////////////////////////////////////
+
+void tick_timer_service_subscribe(TimeUnits tick_units, TickHandler handler) {
+  _tickUnits = tick_units;
+  _tickHandler = handler;
+
+  time_t now = HostTime(NULL);
+  gmtime_r(&now, &_lastTick);
+}
+
+void tick_timer_service_unsubscribe(void) {
+  _tickHandler = NULL;
+}
+
+void accel_tap_service_subscribe(AccelTapHandler handler) {
+  _tapHandler = handler;
+}
+
+void accel_tap_service_unsubscribe(void) {
+  _tapHandler = NULL;
+}
+
+void battery_state_service_subscribe(BatteryStateHandler handler) {
+  _batteryHandler = handler;
+}
+
+void battery_state_service_unsubscribe(void) {
+  _batteryHandler = NULL;
+}
+
+BatteryChargeState battery_state_service_peek(void) {
+  HostConfig *config = HostGetConfig();
+  return (BatteryChargeState) {
+    .charge_percent = config->batteryPercent,
+    .is_charging = config->batteryCharging,
+    .is_plugged = config->batteryCharging,
+  };
+}
+
+void HostSetBattery(uint8_t percent, bool charging) {
+  HostConfig *config = HostGetConfig();
+  config->batteryPercent = percent;
+  config->batteryCharging = charging;
+
+  if (_batteryHandler != NULL) {
+    _batteryHandler(battery_state_service_peek());
+  }
+}
+
+void bluetooth_connection_service_subscribe(BluetoothConnectionHandler handler) {
+  _bluetoothHandler = handler;
+}
+
+void bluetooth_connection_service_unsubscribe(void) {
+  _bluetoothHandler = NULL;
+}
+
+bool bluetooth_connection_service_peek(void) {
+  return HostGetConfig()->bluetoothConnected;
+}
+
+void HostSetBluetooth(bool connected) {
+  HostGetConfig()->bluetoothConnected = connected;
+
+  if (_bluetoothHandler != NULL) {
+    _bluetoothHandler(connected);
+  }
+}
+
+void vibes_short_pulse(void) {
+}
+
+void vibes_long_pulse(void) {
+}
+
+void vibes_double_pulse(void) {
+}
+
+void vibes_cancel(void) {
+}
+
+void app_log(uint8_t log_level, const char *src_filename, int src_line_number, const char *fmt, ...) {
+  if (HostGetConfig()->logging == false) {
+    return;
+  }
+
+  va_list args;
+  va_start(args, fmt);
+  fprintf(stderr, "[%6llu.%03llu] %s:%d ", (unsigned long long) (_nowMs / 1000), (unsigned long long) (_nowMs % 1000),
+          src_filename, src_line_number);
+  vfprintf(stderr, fmt, args);
+  fputc('\n', stderr);
+  va_end(args);
+}
+
+static int64_t nextTickDue(void) {
+  if (_tickHandler == NULL) {
+    return -1;
+  }
+
+  // Ticks land on whole seconds or whole minutes of the virtual wall clock.
+  uint64_t wallMs = (uint64_t) HostGetConfig()->startTime * 1000 + _nowMs;
+  uint64_t unitMs = ((_tickUnits & SECOND_UNIT) != 0) ? 1000 : 60000;
+  uint64_t nextWallMs = ((wallMs / unitMs) + 1) * unitMs;
+  return (int64_t) (nextWallMs - (uint64_t) HostGetConfig()->startTime * 1000);
+}
+
+static void runTick(void) {
+  time_t now = HostTime(NULL);
+  struct tm tickTime;
+  gmtime_r(&now, &tickTime);
+
+  TimeUnits changed = 0;
+  if (tickTime.tm_sec != _lastTick.tm_sec) changed |= SECOND_UNIT;
+  if (tickTime.tm_min != _lastTick.tm_min) changed |= MINUTE_UNIT;
+  if (tickTime.tm_hour != _lastTick.tm_hour) changed |= HOUR_UNIT;
+  if (tickTime.tm_mday != _lastTick.tm_mday) changed |= DAY_UNIT;
+  if (tickTime.tm_mon != _lastTick.tm_mon) changed |= MONTH_UNIT;
+  if (tickTime.tm_year != _lastTick.tm_year) changed |= YEAR_UNIT;
+  _lastTick = tickTime;
+
+  _metrics.tickEvents++;
+  uint32_t appAllocs = _metrics.appAllocs;
+  _tickHandler(&tickTime, changed);
+
+  // A new day can switch scenes, which creates and destroys layers. Any other tick
+  // should only use what the layers already hold.
+  if ((changed & DAY_UNIT) == 0) {
+    _metrics.tickAppAllocs += _metrics.appAllocs - appAllocs;
+  }
+}
+
+////////////////////////////////////////////
+// Event loop
+////////////////////////////////////////////
+
+// Runs the app on the virtual clock until the configured duration has elapsed. Every
+// distinct instant at which something is due counts as one wakeup; all events due at
+// that instant are dispatched before the screen is redrawn once.
+void app_event_loop(void) {
+  HostConfig *config = HostGetConfig();
+  uint64_t endMs = (uint64_t) config->durationSeconds * 1000;
+  uint16_t nextTap = 0;
+
+  _startupCpuNs = HostCpuNs() - _startupCpuNs;
+  atexit(reportAtExit);
+
+  if (HostIsDirty()) {
+    HostRender();
+  }
+
+  while (true) {
+    int64_t tickDue = nextTickDue();
+    uint64_t next = UINT64_MAX;
+    next = minDue(next, HostTimerNextDue());
+    next = minDue(next, HostAnimationNextFrame());
+    next = minDue(next, tickDue);
+    if (HostAppMessagePending()) {
+      next = _nowMs;
+    }
+
+    if (_tapHandler != NULL && nextTap < config->tapCount) {
+      next = minDue(next, (int64_t) config->tapSeconds[nextTap] * 1000);
+    }
+
+    if (next > endMs) {
+      break;
+    }
+
+    if (next > _nowMs || _metrics.wakeups == 0) {
+      _metrics.wakeups++;
+    }
+
+    _nowMs = next;
+    uint64_t startNs = HostCpuNs();
+
+    HostAppMessageRunPending();
+    HostTimerRunDue(_nowMs);
+
+    if (tickDue >= 0 && (uint64_t) tickDue == _nowMs && _tickHandler != NULL) {
+      runTick();
+    }
+
+    while (_tapHandler != NULL && nextTap < config->tapCount && (uint64_t) config->tapSeconds[nextTap] * 1000 <= _nowMs) {
+      nextTap++;
+      _metrics.tapEvents++;
+      _tapHandler(ACCEL_AXIS_Z, 1);
+    }
+
+    if (HostAnimationNextFrame() >= 0 && (uint64_t) HostAnimationNextFrame() <= _nowMs) {
+      HostAnimationRunFrame(_nowMs);
+    }
+
+    _metrics.callbackCpuNs += HostCpuNs() - startNs;
+
+    if (HostIsDirty()) {
+      HostRender();
+    }
+  }
+
+  _nowMs = endMs;
+  _metrics.simulatedMs = endMs;
+
+  if (config->framebufferPath != NULL) {
+    HostWriteFramebuffer(config->framebufferPath);
+  }
+}
+
+// Printed after deinit() so that heap_current shows anything the app leaked.
+static void reportAtExit(void) {
+  HostAppMessageClose();
+  HostPrintReport(stdout);
+}
+
+static uint64_t minDue(uint64_t current, int64_t due) {
+  if (due >= 0 && (uint64_t) due < current) {
+    return due;
+  }
+
+  return current;
+}
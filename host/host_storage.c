@@ -0,0 +1,408 @@
+#define HOST_RUNTIME
+#include "host.h"
+#include <stdarg.h>
+
+#define MAX_PERSIST_KEYS 64
+#define TUPLE_HEADER_SIZE 7
+
+typedef struct {
+  bool used;
+  uint32_t key;
+  uint16_t size;
+  uint8_t data[PERSIST_DATA_MAX_LENGTH];
+} PersistEntry;
+
+static PersistEntry _persist[MAX_PERSIST_KEYS];
+
+static uint8_t *_inbox = NULL;
+static uint8_t *_outbox = NULL;
+static uint32_t _inboxSize = 0;
+static uint32_t _outboxSize = 0;
+static DictionaryIterator _outboxIterator;
+static bool _outboxPending = false;
+static AppMessageInboxReceived _inboxReceived = NULL;
+static AppMessageInboxDropped _inboxDropped = NULL;
+static AppMessageOutboxSent _outboxSent = NULL;
+static AppMessageOutboxFailed _outboxFailed = NULL;
+
+static PersistEntry* findEntry(uint32_t key);
+static int writeEntry(uint32_t key, const void *data, size_t size);
+
+////////////////////////////////////////////
+// Persistent storage
+////////////////////////////////////////////
+
+void HostPersistReset(void) {
+  memset(_persist, 0, sizeof(_persist));
+}
+
+bool persist_exists(const uint32_t key) {
+  HostGetMetrics()->persistReads++;
+  return findEntry(key) != NULL;
+}
+
+int persist_get_size(const uint32_t key) {
+  PersistEntry *entry = findEntry(key);
+  return (entry != NULL) ? entry->size : E_DOES_NOT_EXIST;
+}
+
+bool persist_read_bool(const uint32_t key) {
+  return persist_read_int(key) != 0;
+}
+
+int32_t persist_read_int(const uint32_t key) {
+  HostGetMetrics()->persistReads++;
+  PersistEntry *entry = findEntry(key);
+  int32_t value = 0;
+
+  if (entry != NULL) {
+    memcpy(&value, entry->data, (entry->size < sizeof(value)) ? entry->size : sizeof(value));
+  }
+
+  return value;
+}
+
+int persist_read_data(const uint32_t key, void *buffer, const size_t buffer_size) {
+  HostGetMetrics()->persistReads++;
+  PersistEntry *entry = findEntry(key);
+  if (entry == NULL) {
+    return E_DOES_NOT_EXIST;
+  }
+
+  size_t size = (entry->size < buffer_size) ? entry->size : buffer_size;
+  memcpy(buffer, entry->data, size);
+  return size;
+}
+
+int persist_read_string(const uint32_t key, char *buffer, const size_t buffer_size) {
+  int size = persist_read_data(key, buffer, buffer_size);
+  if (size > 0) {
+    buffer[(size_t) size < buffer_size ? (size_t) size - 1 : buffer_size - 1] = '\0';
+  }
+
+  return size;
+}
+
+status_t persist_write_bool(const uint32_t key, const bool value) {
+  return persist_write_int(key, value ? 1 : 0);
+}
+
+status_t persist_write_int(const uint32_t key, const int32_t value) {
+  int result = writeEntry(key, &value, sizeof(value));
+  return (result < 0) ? result : S_SUCCESS;
+}
+
+int persist_write_data(const uint32_t key, const void *data, const size_t size) {
+  return writeEntry(key, data, size);
+}
+
+int persist_write_string(const uint32_t key, const char *cstring) {
+  return writeEntry(key, cstring, strlen(cstring) + 1);
+}
+
+status_t persist_delete(const uint32_t key) {
+  PersistEntry *entry = findEntry(key);
+  if (entry == NULL) {
+    return E_DOES_NOT_EXIST;
+  }
+
+  entry->used = false;
+  return S_TRUE;
+}
+
+static PersistEntry* findEntry(uint32_t key) {
+  for (uint16_t index = 0; index < MAX_PERSIST_KEYS; index++) {
+    if (_persist[index].used && _persist[index].key == key) {
+      return &_persist[index];
+    }
+  }
+
+  return NULL;
+}
+
+static int writeEntry(uint32_t key, const void *data, size_t size) {
+  if (size > PERSIST_DATA_MAX_LENGTH) {
+    size = PERSIST_DATA_MAX_LENGTH;
+  }
+
+  PersistEntry *entry = findEntry(key);
+  for (uint16_t index = 0; entry == NULL && index < MAX_PERSIST_KEYS; index++) {
+    if (_persist[index].used == false) {
+      entry = &_persist[index];
+    }
+  }
+
+  if (entry == NULL) {
+    return E_OUT_OF_STORAGE;
+  }
+
+  entry->used = true;
+  entry->key = key;
+  entry->size = size;
+  memcpy(entry->data, data, size);
+
+  HostMetrics *metrics = HostGetMetrics();
+  metrics->persistWrites++;
+  metrics->persistBytesWritten += size;
+  return size;
+}
+
+////////////////////////////////////////////
+// Dictionary
+////////////////////////////////////////////
+
+uint32_t dict_calc_buffer_size(const uint8_t tuple_count, ...) {
+  uint32_t size = sizeof(Dictionary);
+  va_list args;
+  va_start(args, tuple_count);
+  for (uint8_t index = 0; index < tuple_count; index++) {
+    size += TUPLE_HEADER_SIZE + va_arg(args, uint32_t);
+  }
+
+  va_end(args);
+  return size;
+}
+
+DictionaryResult dict_write_begin(DictionaryIterator *iter, uint8_t * const buffer, const uint16_t size) {
+  if (iter == NULL || buffer == NULL || size < sizeof(Dictionary)) {
+    return DICT_INVALID_ARGS;
+  }
+
+  iter->dictionary = (Dictionary*) buffer;
+  iter->dictionary->count = 0;
+  iter->cursor = iter->dictionary->head;
+  iter->end = buffer + size;
+  return DICT_OK;
+}
+
+DictionaryResult dict_write_data(DictionaryIterator *iter, const uint32_t key, const uint8_t * const data, const uint16_t size) {
+  if ((uint8_t*) iter->cursor + TUPLE_HEADER_SIZE + size > (uint8_t*) iter->end) {
+    return DICT_NOT_ENOUGH_STORAGE;
+  }
+
+  iter->cursor->key = key;
+  iter->cursor->type = TUPLE_BYTE_ARRAY;
+  iter->cursor->length = size;
+  memcpy(iter->cursor->value->data, data, size);
+  iter->cursor = (Tuple*) ((uint8_t*) iter->cursor + TUPLE_HEADER_SIZE + size);
+  iter->dictionary->count++;
+  return DICT_OK;
+}
+
+DictionaryResult dict_write_int(DictionaryIterator *iter, const uint32_t key, const void *integer, const uint8_t width_bytes, const bool is_signed) {
+  DictionaryResult result = dict_write_data(iter, key, integer, width_bytes);
+  if (result == DICT_OK) {
+    Tuple *tuple = (Tuple*) ((uint8_t*) iter->cursor - TUPLE_HEADER_SIZE - width_bytes);
+    tuple->type = is_signed ? TUPLE_INT : TUPLE_UINT;
+  }
+
+  return result;
+}
+
+DictionaryResult dict_write_int32(DictionaryIterator *iter, const uint32_t key, const int32_t value) {
+  return dict_write_int(iter, key, &value, sizeof(value), true);
+}
+
+DictionaryResult dict_write_tuplet(DictionaryIterator *iter, const Tuplet * const tuplet) {
+  switch (tuplet->type) {
+    case TUPLE_BYTE_ARRAY:
+      return dict_write_data(iter, tuplet->key, tuplet->bytes.data, tuplet->bytes.length);
+
+    case TUPLE_CSTRING: {
+      DictionaryResult result = dict_write_data(iter, tuplet->key, (const uint8_t*) tuplet->cstring.data, tuplet->cstring.length);
+      if (result == DICT_OK) {
+        Tuple *tuple = (Tuple*) ((uint8_t*) iter->cursor - TUPLE_HEADER_SIZE - tuplet->cstring.length);
+        tuple->type = TUPLE_CSTRING;
+      }
+
+      return result;
+    }
+
+    default:
+      return dict_write_int(iter, tuplet->key, &tuplet->integer.storage, tuplet->integer.width, tuplet->type == TUPLE_INT);
+  }
+}
+
+uint32_t dict_write_end(DictionaryIterator *iter) {
+  iter->end = iter->cursor;
+  return (uint8_t*) iter->cursor - (uint8_t*) iter->dictionary;
+}
+
+Tuple* dict_read_begin_from_buffer(DictionaryIterator *iter, const uint8_t * const buffer, const uint16_t size) {
+  iter->dictionary = (Dictionary*) buffer;
+  iter->end = buffer + size;
+  return dict_read_first(iter);
+}
+
+Tuple* dict_read_first(DictionaryIterator *iter) {
+  iter->cursor = iter->dictionary->head;
+  if (iter->dictionary->count == 0 || (uint8_t*) iter->cursor + TUPLE_HEADER_SIZE > (uint8_t*) iter->end) {
+    return NULL;
+  }
+
+  return iter->cursor;
+}
+
+Tuple* dict_read_next(DictionaryIterator *iter) {
+  if (iter->cursor == NULL || (uint8_t*) iter->cursor + TUPLE_HEADER_SIZE > (uint8_t*) iter->end) {
+    return NULL;
+  }
+
+  iter->cursor = (Tuple*) ((uint8_t*) iter->cursor + TUPLE_HEADER_SIZE + iter->cursor->length);
+  if ((uint8_t*) iter->cursor + TUPLE_HEADER_SIZE > (uint8_t*) iter->end) {
+    return NULL;
+  }
+
+  return iter->cursor;
+}
+
+Tuple* dict_find(const DictionaryIterator *iter, const uint32_t key) {
+  DictionaryIterator copy = *iter;
+  for (Tuple *tuple = dict_read_first(&copy); tuple != NULL; tuple = dict_read_next(&copy)) {
+    if (tuple->key == key) {
+      return tuple;
+    }
+  }
+
+  return NULL;
+}
+
+////////////////////////////////////////////
+// AppMessage
+////////////////////////////////////////////
+
+AppMessageResult app_message_open(const uint32_t size_inbound, const uint32_t size_outbound) {
+  if (_inbox != NULL) {
+    return APP_MSG_INVALID_ARGS;
+  }
+
+  // The buffers come out of the app heap, as on the watch.
+  _inbox = HostSdkMalloc(size_inbound);
+  _outbox = HostSdkMalloc(size_outbound);
+  if (_inbox == NULL || _outbox == NULL) {
+    HostAppMessageClose();
+    return APP_MSG_OUT_OF_MEMORY;
+  }
+
+  _inboxSize = size_inbound;
+  _outboxSize = size_outbound;
+  HostGetMetrics()->appMessageInboxSize = size_inbound;
+  HostGetMetrics()->appMessageOutboxSize = size_outbound;
+  return APP_MSG_OK;
+}
+
+void HostAppMessageClose(void) {
+  HostSdkFree(_inbox);
+  HostSdkFree(_outbox);
+  _inbox = NULL;
+  _outbox = NULL;
+  _inboxSize = 0;
+  _outboxSize = 0;
+  _outboxPending = false;
+}
+
+void app_message_deregister_callbacks(void) {
+  _inboxReceived = NULL;
+  _inboxDropped = NULL;
+  _outboxSent = NULL;
+  _outboxFailed = NULL;
+}
+
+AppMessageInboxReceived app_message_register_inbox_received(AppMessageInboxReceived received_callback) {
+  AppMessageInboxReceived previous = _inboxReceived;
+  _inboxReceived = received_callback;
+  return previous;
+}
+
+AppMessageInboxDropped app_message_register_inbox_dropped(AppMessageInboxDropped dropped_callback) {
+  AppMessageInboxDropped previous = _inboxDropped;
+  _inboxDropped = dropped_callback;
+  return previous;
+}
+
+AppMessageOutboxSent app_message_register_outbox_sent(AppMessageOutboxSent sent_callback) {
+  AppMessageOutboxSent previous = _outboxSent;
+  _outboxSent = sent_callback;
+  return previous;
+}
+
+AppMessageOutboxFailed app_message_register_outbox_failed(AppMessageOutboxFailed failed_callback) {
+  AppMessageOutboxFailed previous = _outboxFailed;
+  _outboxFailed = failed_callback;
+  return previous;
+}
+
+uint32_t app_message_inbox_size_maximum(void) {
+  return 656;
+}
+
+uint32_t app_message_outbox_size_maximum(void) {
+  return 656;
+}
+
+AppMessageResult app_message_outbox_begin(DictionaryIterator **iterator) {
+  *iterator = NULL;
+  if (_outbox == NULL) {
+    return APP_MSG_INVALID_ARGS;
+  }
+
+  if (_outboxPending) {
+    return APP_MSG_BUSY;
+  }
+
+  dict_write_begin(&_outboxIterator, _outbox, _outboxSize);
+  *iterator = &_outboxIterator;
+  return APP_MSG_OK;
+}
+
+AppMessageResult app_message_outbox_send(void) {
+  if (_outbox == NULL) {
+    return APP_MSG_INVALID_ARGS;
+  }
+
+  _outboxPending = true;
+  return APP_MSG_OK;
+}
+
+bool HostAppMessagePending(void) {
+  return _outboxPending;
+}
+
+// The phone acknowledges every message on the next pass through the event loop.
+void HostAppMessageRunPending(void) {
+  if (_outboxPending == false) {
+    return;
+  }
+
+  _outboxPending = false;
+  if (_outboxSent != NULL) {
+    DictionaryIterator iterator;
+    dict_read_begin_from_buffer(&iterator, _outbox, (uint8_t*) _outboxIterator.end - _outbox);
+    _outboxSent(&iterator, NULL);
+  }
+}
+
+void HostDeliverInbox(const Tuplet *tuplets, uint8_t count) {
+  if (_inbox == NULL) {
+    return;
+  }
+
+  DictionaryIterator iterator;
+  dict_write_begin(&iterator, _inbox, _inboxSize);
+  for (uint8_t index = 0; index < count; index++) {
+    if (dict_write_tuplet(&iterator, &tuplets[index]) != DICT_OK) {
+      if (_inboxDropped != NULL) {
+        _inboxDropped(APP_MSG_BUFFER_OVERFLOW, NULL);
+      }
+
+      return;
+    }
+  }
+
+  uint32_t size = dict_write_end(&iterator);
+  if (_inboxReceived != NULL) {
+    DictionaryIterator readIterator;
+    dict_read_begin_from_buffer(&readIterator, _inbox, size);
+    _inboxReceived(&readIterator, NULL);
+  }
+}
@@ -0,0 +1,650 @@
+#pragma once
+
+// Host stand-in for the subset of the Pebble SDK 2.x API used by src/. Types and
+// struct layouts follow the SDK closely enough that the watchface compiles unchanged
+// and its casts (e.g. RotBitmapLayer* to BitmapLayer*) behave the same way.
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+#include <time.h>
+
+#include "resource_ids.auto.h"
+
+////////////////////////////////////////////
+// Geometry
+////////////////////////////////////////////
+
+typedef struct GPoint {
+  int16_t x;
+  int16_t y;
+} GPoint;
+
+typedef struct GSize {
+  int16_t w;
+  int16_t h;
+} GSize;
+
+typedef struct GRect {
+  GPoint origin;
+  GSize size;
+} GRect;
+
+// Declared ahead of the GRect() macro, which would otherwise expand here.
+typedef void (*GRectSetter)(void *subject, GRect grect);
+typedef GRect (*GRectGetter)(void *subject);
+
+#define GPoint(x, y) ((GPoint){(x), (y)})
+#define GSize(w, h) ((GSize){(w), (h)})
+#define GRect(x, y, w, h) ((GRect){{(x), (y)}, {(w), (h)}})
+#define GPointZero GPoint(0, 0)
+#define GRectZero GRect(0, 0, 0, 0)
+
+GPoint grect_center_point(const GRect *rect);
+bool grect_equal(const GRect *const rect_a, const GRect *const rect_b);
+bool gpoint_equal(const GPoint *const point_a, const GPoint *const point_b);
+
+////////////////////////////////////////////
+// Graphics
+////////////////////////////////////////////
+
+typedef enum GColor {
+  GColorClear = ~0,
+  GColorBlack = 0,
+  GColorWhite = 1,
+} GColor;
+
+typedef enum {
+  GCompOpAssign,
+  GCompOpAssignInverted,
+  GCompOpOr,
+  GCompOpAnd,
+  GCompOpClear,
+  GCompOpSet,
+} GCompOp;
+
+typedef enum {
+  GCornerNone = 0,
+  GCornerTopLeft = 1 << 0,
+  GCornerTopRight = 1 << 1,
+  GCornerBottomLeft = 1 << 2,
+  GCornerBottomRight = 1 << 3,
+  GCornersAll = GCornerTopLeft | GCornerTopRight | GCornerBottomLeft | GCornerBottomRight,
+} GCornerMask;
+
+typedef enum {
+  GAlignCenter,
+  GAlignTopLeft,
+  GAlignTopRight,
+  GAlignTop,
+  GAlignLeft,
+  GAlignBottom,
+  GAlignRight,
+  GAlignBottomRight,
+  GAlignBottomLeft,
+} GAlign;
+
+typedef enum {
+  GTextAlignmentLeft,
+  GTextAlignmentCenter,
+  GTextAlignmentRight,
+} GTextAlignment;
+
+typedef enum {
+  GTextOverflowModeWordWrap,
+  GTextOverflowModeTrailingEllipsis,
+  GTextOverflowModeFill,
+} GTextOverflowMode;
+
+// 1-bit bitmap. Bit 0 of each byte is the leftmost pixel and a set bit is white.
+// bounds is the region of addr that belongs to this bitmap, which is how sub-bitmaps
+// share the pixel data of their parent.
+typedef struct GBitmap {
+  void *addr;
+  uint16_t row_size_bytes;
+  uint16_t info_flags;
+  GRect bounds;
+} GBitmap;
+
+typedef struct GContext GContext;
+typedef struct FontInfo *GFont;
+
+GBitmap* gbitmap_create_with_resource(uint32_t resource_id);
+GBitmap* gbitmap_create_blank(GSize size);
+GBitmap* gbitmap_create_as_sub_bitmap(const GBitmap *base_bitmap, GRect sub_rect);
+void gbitmap_destroy(GBitmap *bitmap);
+
+void graphics_context_set_stroke_color(GContext *ctx, GColor color);
+void graphics_context_set_fill_color(GContext *ctx, GColor color);
+void graphics_context_set_text_color(GContext *ctx, GColor color);
+void graphics_context_set_compositing_mode(GContext *ctx, GCompOp mode);
+void graphics_draw_pixel(GContext *ctx, GPoint point);
+void graphics_draw_line(GContext *ctx, GPoint p0, GPoint p1);
+void graphics_draw_rect(GContext *ctx, GRect rect);
+void graphics_fill_rect(GContext *ctx, GRect rect, uint16_t corner_radius, GCornerMask corner_mask);
+void graphics_draw_circle(GContext *ctx, GPoint p, uint16_t radius);
+void graphics_fill_circle(GContext *ctx, GPoint p, uint16_t radius);
+void graphics_draw_bitmap_in_rect(GContext *ctx, const GBitmap *bitmap, GRect rect);
+void graphics_draw_text(GContext *ctx, const char *text, GFont const font, const GRect box,
+                        const GTextOverflowMode overflow_mode, const GTextAlignment alignment, void *layout);
+GBitmap* graphics_capture_frame_buffer(GContext *ctx);
+bool graphics_release_frame_buffer(GContext *ctx, GBitmap *buffer);
+bool graphics_frame_buffer_is_captured(GContext *ctx);
+
+#define FONT_KEY_GOTHIC_14 "RESOURCE_ID_GOTHIC_14"
+#define FONT_KEY_GOTHIC_14_BOLD "RESOURCE_ID_GOTHIC_14_BOLD"
+#define FONT_KEY_GOTHIC_18 "RESOURCE_ID_GOTHIC_18"
+#define FONT_KEY_GOTHIC_18_BOLD "RESOURCE_ID_GOTHIC_18_BOLD"
+#define FONT_KEY_GOTHIC_24 "RESOURCE_ID_GOTHIC_24"
+#define FONT_KEY_GOTHIC_24_BOLD "RESOURCE_ID_GOTHIC_24_BOLD"
+#define FONT_KEY_GOTHIC_28 "RESOURCE_ID_GOTHIC_28"
+#define FONT_KEY_GOTHIC_28_BOLD "RESOURCE_ID_GOTHIC_28_BOLD"
+
+GFont fonts_get_system_font(const char *font_key);
+
+////////////////////////////////////////////
+// Math
+////////////////////////////////////////////
+
+#define TRIG_MAX_RATIO 0xffff
+#define TRIG_MAX_ANGLE 0x10000
+
+int32_t sin_lookup(int32_t angle);
+int32_t cos_lookup(int32_t angle);
+
+////////////////////////////////////////////
+// Layers
+////////////////////////////////////////////
+
+typedef struct Layer Layer;
+typedef void (*LayerUpdateProc)(struct Layer *layer, GContext *ctx);
+
+struct Layer {
+  GRect bounds;
+  GRect frame;
+  bool clips;
+  bool hidden;
+  struct Layer *next_sibling;
+  struct Layer *parent;
+  struct Layer *first_child;
+  struct Window *window;
+  LayerUpdateProc update_proc;
+  void *data;
+};
+
+typedef struct BitmapLayer {
+  Layer layer;
+  const GBitmap *bitmap;
+  GColor background_color;
+  GAlign alignment;
+  GCompOp compositing_mode;
+} BitmapLayer;
+
+// Shares the position of the bitmap pointer with BitmapLayer so that the bitmap can be
+// swapped through bitmap_layer_set_bitmap(), as common.c does.
+typedef struct RotBitmapLayer {
+  Layer layer;
+  const GBitmap *bitmap;
+  GColor corner_clip_color;
+  int32_t rotation;
+  GPoint src_ic;
+  GPoint dest_ic;
+  GCompOp compositing_mode;
+} RotBitmapLayer;
+
+typedef struct InverterLayer {
+  Layer layer;
+} InverterLayer;
+
+typedef struct TextLayer {
+  Layer layer;
+  const char *text;
+  GFont font;
+  GColor text_color;
+  GColor background_color;
+  GTextOverflowMode overflow_mode;
+  GTextAlignment text_alignment;
+} TextLayer;
+
+Layer* layer_create(GRect frame);
+Layer* layer_create_with_data(GRect frame, size_t data_size);
+void layer_destroy(Layer *layer);
+void* layer_get_data(const Layer *layer);
+void layer_mark_dirty(Layer *layer);
+void layer_set_update_proc(Layer *layer, LayerUpdateProc update_proc);
+void layer_set_frame(Layer *layer, GRect frame);
+GRect layer_get_frame(const Layer *layer);
+void layer_set_bounds(Layer *layer, GRect bounds);
+GRect layer_get_bounds(const Layer *layer);
+struct Window* layer_get_window(const Layer *layer);
+void layer_remove_from_parent(Layer *child);
+void layer_remove_child_layers(Layer *parent);
+void layer_add_child(Layer *parent, Layer *child);
+void layer_insert_below_sibling(Layer *layer_to_insert, Layer *below_sibling_layer);
+void layer_insert_above_sibling(Layer *layer_to_insert, Layer *above_sibling_layer);
+void layer_set_hidden(Layer *layer, bool hidden);
+bool layer_get_hidden(const Layer *layer);
+void layer_set_clips(Layer *layer, bool clips);
+bool layer_get_clips(const Layer *layer);
+
+BitmapLayer* bitmap_layer_create(GRect frame);
+void bitmap_layer_destroy(BitmapLayer *bitmap_layer);
+Layer* bitmap_layer_get_layer(const BitmapLayer *bitmap_layer);
+const GBitmap* bitmap_layer_get_bitmap(BitmapLayer *bitmap_layer);
+void bitmap_layer_set_bitmap(BitmapLayer *bitmap_layer, const GBitmap *bitmap);
+void bitmap_layer_set_alignment(BitmapLayer *bitmap_layer, GAlign alignment);
+void bitmap_layer_set_background_color(BitmapLayer *bitmap_layer, GColor color);
+void bitmap_layer_set_compositing_mode(BitmapLayer *bitmap_layer, GCompOp mode);
+
+RotBitmapLayer* rot_bitmap_layer_create(GBitmap *bitmap);
+void rot_bitmap_layer_destroy(RotBitmapLayer *bitmap);
+void rot_bitmap_layer_set_corner_clip_color(RotBitmapLayer *bitmap, GColor color);
+void rot_bitmap_layer_set_angle(RotBitmapLayer *bitmap, int32_t angle);
+void rot_bitmap_layer_increment_angle(RotBitmapLayer *bitmap, int32_t angle_change);
+void rot_bitmap_set_src_ic(RotBitmapLayer *bitmap, GPoint ic);
+void rot_bitmap_set_compositing_mode(RotBitmapLayer *bitmap, GCompOp mode);
+
+InverterLayer* inverter_layer_create(GRect frame);
+void inverter_layer_destroy(InverterLayer *inverter_layer);
+Layer* inverter_layer_get_layer(InverterLayer *inverter_layer);
+
+TextLayer* text_layer_create(GRect frame);
+void text_layer_destroy(TextLayer *text_layer);
+Layer* text_layer_get_layer(TextLayer *text_layer);
+void text_layer_set_text(TextLayer *text_layer, const char *text);
+const char* text_layer_get_text(TextLayer *text_layer);
+void text_layer_set_background_color(TextLayer *text_layer, GColor color);
+void text_layer_set_text_color(TextLayer *text_layer, GColor color);
+void text_layer_set_overflow_mode(TextLayer *text_layer, GTextOverflowMode line_mode);
+void text_layer_set_font(TextLayer *text_layer, GFont font);
+void text_layer_set_text_alignment(TextLayer *text_layer, GTextAlignment text_alignment);
+
+////////////////////////////////////////////
+// Windows
+////////////////////////////////////////////
+
+typedef struct Window Window;
+typedef void (*WindowHandler)(struct Window *window);
+
+typedef struct WindowHandlers {
+  WindowHandler load;
+  WindowHandler appear;
+  WindowHandler disappear;
+  WindowHandler unload;
+} WindowHandlers;
+
+Window* window_create(void);
+void window_destroy(Window *window);
+void window_set_window_handlers(Window *window, WindowHandlers handlers);
+Layer* window_get_root_layer(const Window *window);
+void window_set_background_color(Window *window, GColor background_color);
+void window_stack_push(Window *window, bool animated);
+Window* window_stack_pop(bool animated);
+
+////////////////////////////////////////////
+// Animations
+////////////////////////////////////////////
+
+#define ANIMATION_NORMALIZED_MIN 0
+#define ANIMATION_NORMALIZED_MAX 65535
+#define ANIMATION_DURATION_INFINITE ((uint32_t) ~0)
+
+typedef uint32_t AnimationProgress;
+typedef uint32_t AnimationTimingFunction;
+
+typedef enum {
+  AnimationCurveLinear = 0,
+  AnimationCurveEaseIn = 1,
+  AnimationCurveEaseOut = 2,
+  AnimationCurveEaseInOut = 3,
+  AnimationCurveCustomFunction = 4,
+  NumAnimationCurve = 5,
+} AnimationCurve;
+
+typedef struct Animation Animation;
+typedef struct PropertyAnimation PropertyAnimation;
+
+typedef void (*AnimationStartedHandler)(struct Animation *animation, void *context);
+typedef void (*AnimationStoppedHandler)(struct Animation *animation, bool finished, void *context);
+typedef void (*AnimationSetupImplementation)(struct Animation *animation);
+typedef void (*AnimationUpdateImplementation)(struct Animation *animation, const uint32_t time_normalized);
+typedef void (*AnimationTeardownImplementation)(struct Animation *animation);
+typedef AnimationProgress (*AnimationCurveFunction)(AnimationProgress linear_distance);
+
+typedef struct AnimationHandlers {
+  AnimationStartedHandler started;
+  AnimationStoppedHandler stopped;
+} AnimationHandlers;
+
+typedef struct AnimationImplementation {
+  AnimationSetupImplementation setup;
+  AnimationUpdateImplementation update;
+  AnimationTeardownImplementation teardown;
+} AnimationImplementation;
+
+struct Animation {
+  struct Animation *next;
+  const AnimationImplementation *implementation;
+  AnimationHandlers handlers;
+  void *context;
+  int64_t start_time;
+  uint32_t duration;
+  uint32_t delay;
+  AnimationCurve curve;
+  AnimationCurveFunction custom_curve;
+  bool is_scheduled;
+  bool is_started;
+  bool is_property_animation;
+};
+
+
+typedef struct PropertyAnimationAccessors {
+  GRectSetter setter;
+  GRectGetter getter;
+} PropertyAnimationAccessors;
+
+typedef struct PropertyAnimationImplementation {
+  AnimationImplementation base;
+  PropertyAnimationAccessors accessors;
+} PropertyAnimationImplementation;
+
+struct PropertyAnimation {
+  Animation animation;
+  struct {
+    GRect grect;
+  } from, to;
+  void *subject;
+  PropertyAnimationAccessors accessors;
+};
+
+Animation* animation_create(void);
+void animation_destroy(Animation *animation);
+void animation_set_delay(Animation *animation, uint32_t delay_ms);
+void animation_set_duration(Animation *animation, uint32_t duration_ms);
+void animation_set_curve(Animation *animation, AnimationCurve curve);
+void animation_set_custom_curve(Animation *animation, AnimationCurveFunction curve_function);
+void animation_set_handlers(Animation *animation, AnimationHandlers callbacks, void *context);
+void* animation_get_context(Animation *animation);
+void animation_set_implementation(Animation *animation, const AnimationImplementation *implementation);
+void animation_schedule(Animation *animation);
+void animation_unschedule(Animation *animation);
+void animation_unschedule_all(void);
+bool animation_is_scheduled(Animation *animation);
+
+PropertyAnimation* property_animation_create_layer_frame(Layer *layer, GRect *from_frame, GRect *to_frame);
+void property_animation_destroy(PropertyAnimation *property_animation);
+void property_animation_update_grect(PropertyAnimation *property_animation, const uint32_t distance_normalized);
+
+////////////////////////////////////////////
+// Timers and services
+////////////////////////////////////////////
+
+typedef struct AppTimer AppTimer;
+typedef void (*AppTimerCallback)(void *data);
+
+AppTimer* app_timer_register(uint32_t timeout_ms, AppTimerCallback callback, void *callback_data);
+bool app_timer_reschedule(AppTimer *timer_handle, uint32_t new_timeout_ms);
+void app_timer_cancel(AppTimer *timer_handle);
+
+typedef enum {
+  SECOND_UNIT = 1 << 0,
+  MINUTE_UNIT = 1 << 1,
+  HOUR_UNIT = 1 << 2,
+  DAY_UNIT = 1 << 3,
+  MONTH_UNIT = 1 << 4,
+  YEAR_UNIT = 1 << 5,
+} TimeUnits;
+
+typedef void (*TickHandler)(struct tm *tick_time, TimeUnits units_changed);
+
+void tick_timer_service_subscribe(TimeUnits tick_units, TickHandler handler);
+void tick_timer_service_unsubscribe(void);
+
+typedef enum {
+  ACCEL_AXIS_X = 0,
+  ACCEL_AXIS_Y = 1,
+  ACCEL_AXIS_Z = 2,
+} AccelAxisType;
+
+typedef void (*AccelTapHandler)(AccelAxisType axis, int32_t direction);
+
+void accel_tap_service_subscribe(AccelTapHandler handler);
+void accel_tap_service_unsubscribe(void);
+
+typedef struct {
+  uint8_t charge_percent;
+  bool is_charging;
+  bool is_plugged;
+} BatteryChargeState;
+
+typedef void (*BatteryStateHandler)(BatteryChargeState charge);
+
+void battery_state_service_subscribe(BatteryStateHandler handler);
+void battery_state_service_unsubscribe(void);
+BatteryChargeState battery_state_service_peek(void);
+
+typedef void (*BluetoothConnectionHandler)(bool connected);
+
+void bluetooth_connection_service_subscribe(BluetoothConnectionHandler handler);
+void bluetooth_connection_service_unsubscribe(void);
+bool bluetooth_connection_service_peek(void);
+
+void vibes_short_pulse(void);
+void vibes_long_pulse(void);
+void vibes_double_pulse(void);
+void vibes_cancel(void);
+
+bool clock_is_24h_style(void);
+uint16_t time_ms(time_t *tloc, uint16_t *out_ms);
+
+size_t heap_bytes_used(void);
+size_t heap_bytes_free(void);
+
+void app_event_loop(void);
+
+////////////////////////////////////////////
+// Persistent storage
+////////////////////////////////////////////
+
+#define PERSIST_DATA_MAX_LENGTH 256
+#define PERSIST_STRING_MAX_LENGTH PERSIST_DATA_MAX_LENGTH
+
+typedef enum {
+  S_SUCCESS = 0,
+  E_ERROR = -1,
+  E_UNKNOWN = -2,
+  E_INTERNAL = -3,
+  E_INVALID_ARGUMENT = -4,
+  E_OUT_OF_MEMORY = -5,
+  E_OUT_OF_STORAGE = -6,
+  E_OUT_OF_RESOURCES = -7,
+  E_RANGE = -8,
+  E_DOES_NOT_EXIST = -9,
+  E_INVALID_OPERATION = -10,
+  E_BUSY = -11,
+  S_TRUE = 1,
+  S_FALSE = 0,
+  S_NO_MORE_ITEMS = 2,
+  S_NO_ACTION_REQUIRED = 3,
+} StatusCode;
+
+typedef int32_t status_t;
+
+bool persist_exists(const uint32_t key);
+int persist_get_size(const uint32_t key);
+bool persist_read_bool(const uint32_t key);
+int32_t persist_read_int(const uint32_t key);
+int persist_read_data(const uint32_t key, void *buffer, const size_t buffer_size);
+int persist_read_string(const uint32_t key, char *buffer, const size_t buffer_size);
+status_t persist_write_bool(const uint32_t key, const bool value);
+status_t persist_write_int(const uint32_t key, const int32_t value);
+int persist_write_data(const uint32_t key, const void *data, const size_t size);
+int persist_write_string(const uint32_t key, const char *cstring);
+status_t persist_delete(const uint32_t key);
+
+////////////////////////////////////////////
+// Dictionary and AppMessage
+////////////////////////////////////////////
+
+typedef enum {
+  TUPLE_BYTE_ARRAY = 0,
+  TUPLE_CSTRING = 1,
+  TUPLE_UINT = 2,
+  TUPLE_INT = 3,
+} TupleType;
+
+typedef struct __attribute__((__packed__)) {
+  uint32_t key;
+  TupleType type:8;
+  uint16_t length;
+  union {
+    uint8_t data[0];
+    char cstring[0];
+    uint8_t uint8;
+    uint16_t uint16;
+    uint32_t uint32;
+    int8_t int8;
+    int16_t int16;
+    int32_t int32;
+  } value[];
+} Tuple;
+
+typedef struct __attribute__((__packed__)) Dictionary {
+  uint8_t count;
+  Tuple head[];
+} Dictionary;
+
+typedef struct {
+  Dictionary *dictionary;
+  const void *end;
+  Tuple *cursor;
+} DictionaryIterator;
+
+typedef struct Tuplet {
+  TupleType type;
+  uint32_t key;
+  union {
+    struct {
+      const uint8_t *data;
+      const uint16_t length;
+    } bytes;
+    struct {
+      const char *data;
+      const uint16_t length;
+    } cstring;
+    struct {
+      uint32_t storage;
+      const uint16_t width;
+    } integer;
+  };
+} Tuplet;
+
+#define TupletBytes(_key, _data, _length) \
+  ((const Tuplet) { .type = TUPLE_BYTE_ARRAY, .key = _key, .bytes = { .data = _data, .length = _length }})
+static inline uint16_t HostCStringLength(const char *cstring) {
+  return (cstring != NULL) ? strlen(cstring) + 1 : 0;
+}
+
+#define TupletCString(_key, _cstring) \
+  ((const Tuplet) { .type = TUPLE_CSTRING, .key = _key, .cstring = { .data = _cstring, .length = HostCStringLength(_cstring) }})
+#define TupletInteger(_key, _integer) \
+  ((const Tuplet) { .type = TUPLE_INT, .key = _key, .integer = { .storage = _integer, .width = sizeof(_integer) }})
+
+typedef enum {
+  DICT_OK = 0,
+  DICT_NOT_ENOUGH_STORAGE = 1 << 1,
+  DICT_INVALID_ARGS = 1 << 2,
+  DICT_INTERNAL_INCONSISTENCY = 1 << 3,
+  DICT_MALLOC_FAILED = 1 << 4,
+} DictionaryResult;
+
+uint32_t dict_calc_buffer_size(const uint8_t tuple_count, ...);
+DictionaryResult dict_write_begin(DictionaryIterator *iter, uint8_t * const buffer, const uint16_t size);
+DictionaryResult dict_write_data(DictionaryIterator *iter, const uint32_t key, const uint8_t * const data, const uint16_t size);
+DictionaryResult dict_write_int(DictionaryIterator *iter, const uint32_t key, const void *integer, const uint8_t width_bytes, const bool is_signed);
+DictionaryResult dict_write_int32(DictionaryIterator *iter, const uint32_t key, const int32_t value);
+DictionaryResult dict_write_tuplet(DictionaryIterator *iter, const Tuplet * const tuplet);
+uint32_t dict_write_end(DictionaryIterator *iter);
+Tuple* dict_read_begin_from_buffer(DictionaryIterator *iter, const uint8_t * const buffer, const uint16_t size);
+Tuple* dict_read_first(DictionaryIterator *iter);
+Tuple* dict_read_next(DictionaryIterator *iter);
+Tuple* dict_find(const DictionaryIterator *iter, const uint32_t key);
+
+typedef enum {
+  APP_MSG_OK = 0,
+  APP_MSG_SEND_TIMEOUT = 1 << 1,
+  APP_MSG_SEND_REJECTED = 1 << 2,
+  APP_MSG_NOT_CONNECTED = 1 << 3,
+  APP_MSG_APP_NOT_RUNNING = 1 << 4,
+  APP_MSG_INVALID_ARGS = 1 << 5,
+  APP_MSG_BUSY = 1 << 6,
+  APP_MSG_BUFFER_OVERFLOW = 1 << 7,
+  APP_MSG_ALREADY_RELEASED = 1 << 9,
+  APP_MSG_CALLBACK_ALREADY_REGISTERED = 1 << 10,
+  APP_MSG_CALLBACK_NOT_REGISTERED = 1 << 11,
+  APP_MSG_OUT_OF_MEMORY = 1 << 12,
+  APP_MSG_CLOSED = 1 << 13,
+  APP_MSG_INTERNAL_ERROR = 1 << 14,
+} AppMessageResult;
+
+#define APP_MESSAGE_INBOX_SIZE_MINIMUM 124
+#define APP_MESSAGE_OUTBOX_SIZE_MINIMUM 636
+
+typedef void (*AppMessageInboxReceived)(DictionaryIterator *iterator, void *context);
+typedef void (*AppMessageInboxDropped)(AppMessageResult reason, void *context);
+typedef void (*AppMessageOutboxSent)(DictionaryIterator *iterator, void *context);
+typedef void (*AppMessageOutboxFailed)(DictionaryIterator *iterator, AppMessageResult reason, void *context);
+
+AppMessageResult app_message_open(const uint32_t size_inbound, const uint32_t size_outbound);
+void app_message_deregister_callbacks(void);
+AppMessageInboxReceived app_message_register_inbox_received(AppMessageInboxReceived received_callback);
+AppMessageInboxDropped app_message_register_inbox_dropped(AppMessageInboxDropped dropped_callback);
+AppMessageOutboxSent app_message_register_outbox_sent(AppMessageOutboxSent sent_callback);
+AppMessageOutboxFailed app_message_register_outbox_failed(AppMessageOutboxFailed failed_callback);
+uint32_t app_message_inbox_size_maximum(void);
+uint32_t app_message_outbox_size_maximum(void);
+AppMessageResult app_message_outbox_begin(DictionaryIterator **iterator);
+AppMessageResult app_message_outbox_send(void);
+
+////////////////////////////////////////////
+// Logging
+////////////////////////////////////////////
+
+typedef enum {
+  APP_LOG_LEVEL_ERROR = 1,
+  APP_LOG_LEVEL_WARNING = 50,
+  APP_LOG_LEVEL_INFO = 100,
+  APP_LOG_LEVEL_DEBUG = 200,
+  APP_LOG_LEVEL_DEBUG_VERBOSE = 255,
+} AppLogLevel;
+
+void app_log(uint8_t log_level, const char *src_filename, int src_line_number, const char *fmt, ...)
+  __attribute__((format(printf, 4, 5)));
+
+#define APP_LOG(level, fmt, args...) \
+  app_log(level, __FILE_NAME__, __LINE__, fmt, ## args)
+
+////////////////////////////////////////////
+// Host redirections
+////////////////////////////////////////////
+
+// The watchface code sees the virtual clock and the accounted app heap. The stand-in
+// itself is built with HOST_RUNTIME defined so it can reach the real C library.
+#ifndef HOST_RUNTIME
+void* HostAppMalloc(size_t size);
+void* HostAppCalloc(size_t count, size_t size);
+void* HostAppRealloc(void *ptr, size_t size);
+void HostAppFree(void *ptr);
+time_t HostTime(time_t *tloc);
+struct tm* HostLocaltime(const time_t *timep);
+
+#define malloc(size) HostAppMalloc(size)
+#define calloc(count, size) HostAppCalloc(count, size)
+#define realloc(ptr, size) HostAppRealloc(ptr, size)
+#define free(ptr) HostAppFree(ptr)
+#define time(tloc) HostTime(tloc)
+#define localtime(timep) HostLocaltime(timep)
+#endif
@@ -0,0 +1,139 @@
+#include <pebble.h>
+#include "background_layer.h"
+
+static void backgroundUpdateProc(Layer *layer, GContext *ctx);
+static void captureUpdateProc(Layer *layer, GContext *ctx);
+static bool hideContentCallback(void *context, uint32_t elapsedMs);
+static void copyScreen(GBitmap *target, const GBitmap *source);
+
+BackgroundLayerData* CreateBackgroundLayer(Layer *relativeLayer, LayerRelation relation) {
+  BackgroundLayerData *data = malloc(sizeof(BackgroundLayerData));
+  if (data != NULL) {
+    memset(data, 0, sizeof(BackgroundLayerData));
+    
+    // Anywhere but the bottom of a window, the capture would also take in whatever was
+    // drawn below it. Without a cache the content simply draws on every frame.
+    Window *window = layer_get_window(relativeLayer);
+    if (relation == CHILD && window != NULL && window_get_root_layer(window) == relativeLayer) {
+      data->cache = gbitmap_create_blank(GSize(SCREEN_WIDTH, SCREEN_HEIGHT));
+    } else {
+      MY_APP_LOG(APP_LOG_LEVEL_WARNING, "Background layer not at the bottom of a window, not cached");
+    }
+    
+    data->layer = layer_create_with_data(GRect(0, 0, SCREEN_WIDTH, SCREEN_HEIGHT), sizeof(BackgroundLayerData*));
+    *(BackgroundLayerData**) layer_get_data(data->layer) = data;
+    layer_set_update_proc(data->layer, backgroundUpdateProc);
+    AddLayer(relativeLayer, data->layer, relation);
+    
+    data->contentLayer = layer_create(GRect(0, 0, SCREEN_WIDTH, SCREEN_HEIGHT));
+    AddLayer(data->layer, data->contentLayer, CHILD);
+    
+    // The last child, so it is drawn straight after the content whatever else is added
+    // to the window.
+    data->captureLayer = layer_create_with_data(GRect(0, 0, SCREEN_WIDTH, SCREEN_HEIGHT), sizeof(BackgroundLayerData*));
+    *(BackgroundLayerData**) layer_get_data(data->captureLayer) = data;
+    layer_set_update_proc(data->captureLayer, captureUpdateProc);
+    AddLayer(data->layer, data->captureLayer, CHILD);
+  }
+  
+  return data;
+}
+
+// Has the content draw on the next frame, to be cached again. Call whenever a layer in
+// the content changes.
+void InvalidateBackgroundLayer(BackgroundLayerData *data) {
+  data->cached = false;
+  SetLayerHidden(data->contentLayer, &data->contentHidden, false);
+  layer_mark_dirty(data->layer);
+  
+  if (data->cache != NULL) {
+    FrameSchedulerAdd(hideContentCallback, data, FRAME_INTERVAL);
+  }
+}
+
+void DestroyBackgroundLayer(BackgroundLayerData *data) {
+  if (data != NULL) {
+    FrameSchedulerRemove(hideContentCallback, data);
+    
+    if (data->captureLayer != NULL) {
+      layer_remove_from_parent(data->captureLayer);
+      layer_destroy(data->captureLayer);
+      data->captureLayer = NULL;
+    }
+    
+    if (data->contentLayer != NULL) {
+      layer_remove_from_parent(data->contentLayer);
+      layer_destroy(data->contentLayer);
+      data->contentLayer = NULL;
+    }
+    
+    if (data->layer != NULL) {
+      layer_remove_from_parent(data->layer);
+      layer_destroy(data->layer);
+      data->layer = NULL;
+    }
+    
+    if (data->cache != NULL) {
+      gbitmap_destroy(data->cache);
+      data->cache = NULL;
+    }
+    
+    free(data);
+  }
+}
+
+static void backgroundUpdateProc(Layer *layer, GContext *ctx) {
+  BackgroundLayerData *data = *(BackgroundLayerData**) layer_get_data(layer);
+  if (data->contentHidden == false) {
+    return;
+  }
+  
+  GBitmap *framebuffer = graphics_capture_frame_buffer(ctx);
+  if (framebuffer != NULL) {
+    copyScreen(framebuffer, data->cache);
+    graphics_release_frame_buffer(ctx, framebuffer);
+  }
+}
+
+// Only the window background and the content have been drawn when this runs, as the
+// background layer is the window's first layer.
+static void captureUpdateProc(Layer *layer, GContext *ctx) {
+  BackgroundLayerData *data = *(BackgroundLayerData**) layer_get_data(layer);
+  if (data->cached || data->cache == NULL) {
+    return;
+  }
+  
+  GBitmap *framebuffer = graphics_capture_frame_buffer(ctx);
+  if (framebuffer == NULL) {
+    return;
+  }
+  
+  copyScreen(data->cache, framebuffer);
+  graphics_release_frame_buffer(ctx, framebuffer);
+  data->cached = true;
+}
+
+// Hides the content from the first frame after the cache took it in, outside the render
+// pass. Frames are aligned, so while anything else animates the hide joins its next frame.
+static bool hideContentCallback(void *context, uint32_t elapsedMs) {
+  BackgroundLayerData *data = context;
+  if (data->cached == false) {
+    return true;
+  }
+  
+  SetLayerHidden(data->contentLayer, &data->contentHidden, true);
+  return false;
+}
+
+static void copyScreen(GBitmap *target, const GBitmap *source) {
+  if (target->row_size_bytes == source->row_size_bytes) {
+    memcpy(target->addr, source->addr, source->row_size_bytes * SCREEN_HEIGHT);
+    return;
+  }
+  
+  uint16_t rowBytes = (target->row_size_bytes < source->row_size_bytes) ? target->row_size_bytes : source->row_size_bytes;
+  for (int16_t y = 0; y < SCREEN_HEIGHT; y++) {
+    memcpy((uint8_t*) target->addr + y * target->row_size_bytes,
+           (const uint8_t*) source->addr + y * source->row_size_bytes, rowBytes);
+  }
+}
\ No newline at end of file
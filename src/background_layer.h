@@ -0,0 +1,22 @@
+#pragma once
+#include "common.h"
+
+// The parts of the face that change at most once a minute: the markers, the hour and the
+// status text. Their layers are children of contentLayer and only draw after the
+// background is invalidated. The frame they draw is kept in a screen-sized bitmap, and
+// once the content is hidden again the background layer copies it to the screen instead.
+//
+// The cache is a copy of the whole screen, so the background layer must be the first
+// layer of its window: created as a child of the window's root layer before any other.
+typedef struct {
+  Layer *layer;           // Copies the cache to the screen, parent of the two below
+  Layer *contentLayer;    // Parent of the layers drawn into the cache
+  Layer *captureLayer;    // Drawn after the content, copies it into the cache
+  GBitmap *cache;         // NULL unless the layer is at the bottom of its window
+  bool cached;            // The cache holds the content as it is now
+  bool contentHidden;
+} BackgroundLayerData;
+
+BackgroundLayerData* CreateBackgroundLayer(Layer *relativeLayer, LayerRelation relation);
+void InvalidateBackgroundLayer(BackgroundLayerData *data);
+void DestroyBackgroundLayer(BackgroundLayerData *data);
\ No newline at end of file
@@ -0,0 +1,136 @@
+#include <pebble.h>
+#include "bitmap_cache.h"
+
+#define MAX_CACHED_BITMAPS 16
+
+// Bound on the decoded bytes kept for idle bitmaps. Idle bitmaps are evicted oldest first
+// while everything cached, in use or not, is over it. Bitmaps in use are never evicted,
+// so the total can exceed it while they are held. Fits the duck's poses. The digits atlas
+// and the shark eat strip are each larger than it. They are decoded on top of the idle
+// bitmaps and destroyed as soon as released.
+#define BITMAP_CACHE_BUDGET 3072
+
+typedef struct {
+  uint32_t resourceId;
+  GBitmap *bitmap;
+  uint16_t refCount;
+  uint16_t bytes;
+  uint32_t lastUsed;
+} CachedBitmap;
+
+static CachedBitmap _cache[MAX_CACHED_BITMAPS];
+static uint32_t _cacheBytes = 0;
+static uint32_t _useCounter = 0;
+
+static CachedBitmap* findCachedBitmap(uint32_t resourceId);
+static bool evictIdleBitmap();
+static void destroyCachedBitmap(CachedBitmap *entry);
+static void trimCache(uint32_t neededBytes);
+
+GBitmap* BitmapCacheAcquire(uint32_t resourceId) {
+  CachedBitmap *entry = findCachedBitmap(resourceId);
+  
+  if (entry == NULL) {
+    GBitmap *bitmap = gbitmap_create_with_resource(resourceId);
+    if (bitmap == NULL) {
+      return NULL;
+    }
+    
+    // A bitmap over the budget is never kept idle, so there is no point in evicting the
+    // idle bitmaps to make room for it.
+    uint16_t bytes = bitmap->row_size_bytes * bitmap->bounds.size.h;
+    trimCache((bytes > BITMAP_CACHE_BUDGET) ? 0 : bytes);
+    
+    entry = findCachedBitmap(0);
+    if (entry == NULL && evictIdleBitmap()) {
+      entry = findCachedBitmap(0);
+    }
+    
+    // Every slot is referenced. Nothing is handed out, so there is nothing to release.
+    if (entry == NULL) {
+      MY_APP_LOG(APP_LOG_LEVEL_WARNING, "Bitmap cache full, resource %i not cached", (int) resourceId);
+      gbitmap_destroy(bitmap);
+      return NULL;
+    }
+    
+    entry->resourceId = resourceId;
+    entry->bitmap = bitmap;
+    entry->refCount = 0;
+    entry->bytes = bytes;
+    _cacheBytes += bytes;
+  }
+  
+  entry->refCount++;
+  entry->lastUsed = ++_useCounter;
+  return entry->bitmap;
+}
+
+void BitmapCacheRelease(uint32_t resourceId) {
+  CachedBitmap *entry = findCachedBitmap(resourceId);
+  if (entry == NULL || entry->refCount == 0) {
+    return;
+  }
+  
+  entry->refCount--;
+  if (entry->refCount > 0) {
+    return;
+  }
+  
+  if (entry->bytes > BITMAP_CACHE_BUDGET) {
+    destroyCachedBitmap(entry);
+  } else {
+    trimCache(0);
+  }
+}
+
+void DestroyBitmapCache() {
+  for (int index = 0; index < MAX_CACHED_BITMAPS; index++) {
+    if (_cache[index].bitmap != NULL) {
+      gbitmap_destroy(_cache[index].bitmap);
+    }
+  }
+  
+  memset(_cache, 0, sizeof(_cache));
+  _cacheBytes = 0;
+}
+
+static CachedBitmap* findCachedBitmap(uint32_t resourceId) {
+  for (int index = 0; index < MAX_CACHED_BITMAPS; index++) {
+    if (_cache[index].resourceId == resourceId) {
+      return &_cache[index];
+    }
+  }
+  
+  return NULL;
+}
+
+// Destroys the least recently used bitmap nothing references. Returns false if every
+// cached bitmap is in use.
+static bool evictIdleBitmap() {
+  CachedBitmap *oldest = NULL;
+  
+  for (int index = 0; index < MAX_CACHED_BITMAPS; index++) {
+    CachedBitmap *entry = &_cache[index];
+    if (entry->bitmap != NULL && entry->refCount == 0 && (oldest == NULL || entry->lastUsed < oldest->lastUsed)) {
+      oldest = entry;
+    }
+  }
+  
+  if (oldest == NULL) {
+    return false;
+  }
+  
+  destroyCachedBitmap(oldest);
+  return true;
+}
+
+static void destroyCachedBitmap(CachedBitmap *entry) {
+  gbitmap_destroy(entry->bitmap);
+  _cacheBytes -= entry->bytes;
+  memset(entry, 0, sizeof(CachedBitmap));
+}
+
+static void trimCache(uint32_t neededBytes) {
+  while (_cacheBytes + neededBytes > BITMAP_CACHE_BUDGET && evictIdleBitmap()) {
+  }
+}
@@ -0,0 +1,12 @@
+#pragma once
+#include "common.h"
+
+// Shared cache of decoded image resources. Every BitmapCacheAcquire must be paired with
+// a BitmapCacheRelease of the same resource. Released bitmaps stay decoded while the
+// cache is within its byte budget, so switching back to them costs no PNG decode.
+// BitmapCacheAcquire returns NULL if the resource can't be loaded or every slot is in
+// use, and a NULL acquire must not be released.
+
+GBitmap* BitmapCacheAcquire(uint32_t resourceId);
+void BitmapCacheRelease(uint32_t resourceId);
+void DestroyBitmapCache();
@@ -1,8 +1,11 @@
 #pragma once
 #include "common.h"
+#include "particle_engine.h"
   
 typedef struct {
   Layer* layer;
+  ParticleEngine particles;
+  uint32_t pendingMs;
   int16_t lastUpdateMinute;
   uint16_t nextMinute;
 } BubbleLayerData;
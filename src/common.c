@@ -1,7 +1,49 @@
 #include <pebble.h>
 #include "common.h"
+#include "bitmap_cache.h"
+#include "rotation_cache.h"
+#include "sprite_blit.h"
 
-static uint16_t getImageHypotenuse(uint32_t imageResourceId);
+typedef struct {
+  FrameCallback callback;
+  void *context;
+  uint16_t intervalMs;
+  uint32_t lastMs;
+  uint32_t dueMs;
+} FrameEntry;
+
+typedef struct {
+  TransitionCallback callback;
+  AnimationStoppedHandler stopped;
+  void *context;
+} TransitionEntry;
+
+static FrameEntry _frameEntries[MAX_FRAME_CALLBACKS];
+static AppTimer *_frameTimer = NULL;
+static uint32_t _frameDueMs = 0;
+static TransitionEntry _transitionEntries[MAX_TRANSITION_CALLBACKS];
+static Animation *_transition = NULL;
+static bool _transitionMoving = false;
+static PowerTier _powerTier = POWER_FULL;
+
+static void bitmapGroupUpdateProc(Layer *layer, GContext *ctx);
+static void showRotatedBitmap(RotBitmapGroup *group);
+static void frameAnimationUpdate(Animation *animation, const uint32_t distance_normalized);
+static uint32_t nextFrameDue(uint32_t now, uint16_t intervalMs);
+static void scheduleFrame(uint32_t now);
+static void frameTimerCallback(void *callback_data);
+static FrameEntry* findFrameEntry(FrameCallback callback, void *context);
+static void minuteTransitionUpdate(Animation *animation, const uint32_t distance_normalized);
+static void minuteTransitionStopped(Animation *animation, bool finished, void *context);
+static TransitionEntry* findTransitionEntry(TransitionCallback callback, void *context);
+
+static const AnimationImplementation _frameAnimationImplementation = {
+  .update = frameAnimationUpdate,
+};
+
+static const AnimationImplementation _minuteTransitionImplementation = {
+  .update = minuteTransitionUpdate,
+};
 
 void AddLayer(Layer *relativeLayer, Layer *newLayer, LayerRelation relation) {
   switch (relation) {
@@ -26,6 +68,16 @@ void SetLayerHidden(Layer *layer, bool *currentHidden, bool newHidden) {
   }
 }
 
+// Creates the group's layer with no bitmap shown.
+void InitBitmapGroup(BitmapGroup *group, GRect frame) {
+  memset(group, 0, sizeof(BitmapGroup));
+  group->layer = layer_create_with_data(frame, sizeof(const GBitmap*));
+  if (group->layer != NULL) {
+    *(const GBitmap**) layer_get_data(group->layer) = NULL;
+    layer_set_update_proc(group->layer, bitmapGroupUpdateProc);
+  }
+}
+
 // Returns whether the bitmap was changed.
 bool BitmapGroupSetBitmap(BitmapGroup *group, uint32_t imageResourceId) {
   bool imageChanged = false;
@@ -33,37 +85,36 @@ bool BitmapGroupSetBitmap(BitmapGroup *group, uint32_t imageResourceId) {
   if (group->resourceId != imageResourceId) {
     imageChanged = true;
     
-    if (group->bitmap != NULL) {
-      gbitmap_destroy(group->bitmap);
-      group->bitmap = NULL;
-      group->resourceId = 0;
-    }
+    // Acquire the new bitmap before releasing the old one so the layer never points at
+    // a destroyed bitmap.
+    uint32_t oldResourceId = group->resourceId;
+    group->bitmap = BitmapCacheAcquire(imageResourceId);
+    group->resourceId = (group->bitmap != NULL) ? imageResourceId : 0;
+    BitmapGroupShowBitmap(group, group->bitmap);
     
-    group->bitmap = gbitmap_create_with_resource(imageResourceId);
-    group->resourceId = imageResourceId;
-    bitmap_layer_set_bitmap((BitmapLayer*) group->layer, group->bitmap);
+    if (oldResourceId != 0) {
+      BitmapCacheRelease(oldResourceId);
+    }
   }
   
   return imageChanged;
 }
 
-// Returns new GRect frame for the RotBitmapLayer. Frame and bounds will be adjusted to
-// new image, however the frame will most likely not be in the right position.
+// Returns new GRect frame for the layer. Frame and bounds will be adjusted to new image,
+// however the frame will most likely not be in the right position.
 GRect RotBitmapGroupChangeBitmap(RotBitmapGroup *group, uint32_t imageResourceId) {
-  if (group->bitmap != NULL) {
-    gbitmap_destroy(group->bitmap);
-    group->bitmap = NULL;
-    group->resourceId = 0;
+  // Show the new image at the current angle before releasing the old one.
+  uint32_t oldResourceId = group->resourceId;
+  group->bitmap = BitmapCacheAcquire(imageResourceId);
+  group->resourceId = (group->bitmap != NULL) ? imageResourceId : 0;
+  showRotatedBitmap(group);
+  
+  if (oldResourceId != 0) {
+    BitmapCacheRelease(oldResourceId);
   }
 
-  // Create and set the new bitmap on the RotBitmapLayer
-  group->bitmap = gbitmap_create_with_resource(imageResourceId);
-  group->resourceId = imageResourceId;
-  bitmap_layer_set_bitmap((BitmapLayer*) group->layer, group->bitmap);
-
-  // Get the hypotenuse of the new image which is what the RotBitmapLayer uses
-  // for the frame width & height.
-  uint16_t hypotenuse = getImageHypotenuse(imageResourceId);
+  // The rendering is the hypotenuse of the image on each side, so it fits any angle.
+  uint16_t hypotenuse = GetImageHypotenuse(imageResourceId);
 
   // Adjust the frame size
   GRect rotFrame = layer_get_frame((Layer*) group->layer);   
@@ -73,26 +124,39 @@ GRect RotBitmapGroupChangeBitmap(RotBitmapGroup *group, uint32_t imageResourceId
 
   // Adjust the bounds
   layer_set_bounds((Layer*) group->layer, GRect(0, 0, hypotenuse, hypotenuse));
-
-  // Set the center point for the new bitmap. This causes the RotBitmapLayer to
-  // center the new bitmap.
-  rot_bitmap_set_src_ic(group->layer, grect_center_point(&group->bitmap->bounds));
   
   return rotFrame;
 }
 
+// Turns the image to angle degrees. The rendering comes from the rotation cache, so
+// the layer draws a plain bitmap however often it is redrawn.
+void RotBitmapGroupSetAngle(RotBitmapGroup *group, int32_t angle) {
+  if (group->angle != angle) {
+    group->angle = angle;
+    showRotatedBitmap(group);
+  }
+}
+
+// Draws bitmap, such as a sub-bitmap of the group's image, until the image is next set.
+void BitmapGroupShowBitmap(BitmapGroup *group, const GBitmap *bitmap) {
+  if (group->layer != NULL) {
+    *(const GBitmap**) layer_get_data(group->layer) = bitmap;
+    layer_mark_dirty(group->layer);
+  }
+}
+
 void DestroyBitmapGroup(BitmapGroup *group) {
   if (group != NULL) {
-    if (group->bitmap != NULL) {
-      gbitmap_destroy(group->bitmap);
-      group->bitmap = NULL;
+    if (group->resourceId != 0) {
+      BitmapCacheRelease(group->resourceId);
     }
     
+    group->bitmap = NULL;
     group->resourceId = 0;
     
     if (group->layer != NULL) {
-      layer_remove_from_parent((Layer*) group->layer);
-      bitmap_layer_destroy(group->layer);
+      layer_remove_from_parent(group->layer);
+      layer_destroy(group->layer);
       group->layer = NULL;
     }
   }
@@ -100,60 +164,376 @@ void DestroyBitmapGroup(BitmapGroup *group) {
 
 void DestroyRotBitmapGroup(RotBitmapGroup *group) {
   if (group != NULL) {
-    if (group->bitmap != NULL) {
-      gbitmap_destroy(group->bitmap);
-      group->bitmap = NULL;
+    if (group->resourceId != 0) {
+      BitmapCacheRelease(group->resourceId);
     }
     
+    group->bitmap = NULL;
     group->resourceId = 0;
     
     if (group->layer != NULL) {
       layer_remove_from_parent((Layer*) group->layer);
-      rot_bitmap_layer_destroy(group->layer);
+      bitmap_layer_destroy(group->layer);
       group->layer = NULL;
     }
+    
+    if (group->rotated != NULL) {
+      RotationCacheRelease(group->rotated);
+      group->rotated = NULL;
+    }
   }
 }
 
-bool isBufferFull(uint16_t start, uint16_t end, uint16_t size) {
-  if ((end + 1) == start || (start == 0 && end == (size - 1))) {
+void InitFrameAnimation(FrameAnimation *frameAnimation, Layer *layer) {
+  memset(frameAnimation, 0, sizeof(FrameAnimation));
+  frameAnimation->layer = layer;
+  frameAnimation->animation = animation_create();
+}
+
+// Moves the animation from where the layer is now to the frame to. Returns false if the
+// animation could not be created, in which case the layer is put straight at to.
+bool RetargetFrameAnimation(FrameAnimation *frameAnimation, GRect to) {
+  if (frameAnimation->animation == NULL) {
+    layer_set_frame(frameAnimation->layer, to);
+    return false;
+  }
+  
+  frameAnimation->from = layer_get_frame(frameAnimation->layer);
+  frameAnimation->to = to;
+  
+  // Set on every run, as the profiler hands the animation its implementation and
+  // handlers back when it stops.
+  animation_set_implementation(frameAnimation->animation, &_frameAnimationImplementation);
+  animation_set_handlers(frameAnimation->animation, (AnimationHandlers) {
+    .started = NULL,
+    .stopped = NULL,
+  }, (void*) frameAnimation);
+  
+  return true;
+}
+
+bool FrameAnimationIsRunning(FrameAnimation *frameAnimation) {
+  return (frameAnimation->animation != NULL && animation_is_scheduled(frameAnimation->animation));
+}
+
+void DestroyFrameAnimation(FrameAnimation *frameAnimation) {
+  if (frameAnimation->animation != NULL) {
+    animation_unschedule(frameAnimation->animation);
+    animation_destroy(frameAnimation->animation);
+    frameAnimation->animation = NULL;
+  }
+}
+
+// Returns the hypotenuse of the image, the side of the square it fits at any angle.
+// The values are generated from the images by tools/pack_sprites.py.
+uint16_t GetImageHypotenuse(uint32_t imageResourceId) {
+  switch (imageResourceId) {
+#define HYPOTENUSE_CASE(name, width, height, hypotenuse) \
+    case RESOURCE_ID_##name: return hypotenuse;
+    SPRITE_METRICS(HYPOTENUSE_CASE)
+#undef HYPOTENUSE_CASE
+    default:
+      return 0;
+  }
+}
+
+// Milliseconds on the watch clock, for positions that are computed from elapsed time.
+uint32_t NowMs() {
+  time_t seconds;
+  uint16_t milliseconds;
+  time_ms(&seconds, &milliseconds);
+  return (uint32_t) seconds * 1000 + milliseconds;
+}
+
+// Adds callback to run every intervalMs until it returns false or is removed. Intervals
+// should be multiples of FRAME_INTERVAL so that callbacks due together share a wakeup.
+// Returns false if there is no room for it. Adding a callback that is already pending
+// does nothing.
+bool FrameSchedulerAdd(FrameCallback callback, void *context, uint16_t intervalMs) {
+  if (findFrameEntry(callback, context) != NULL) {
     return true;
   }
   
-  return false;
+  FrameEntry *entry = findFrameEntry(NULL, NULL);
+  if (entry == NULL) {
+    return false;
+  }
+  
+  uint32_t now = NowMs();
+  entry->callback = callback;
+  entry->context = context;
+  entry->intervalMs = (intervalMs > FRAME_INTERVAL) ? intervalMs : FRAME_INTERVAL;
+  entry->lastMs = now;
+  entry->dueMs = nextFrameDue(now, entry->intervalMs);
+  scheduleFrame(now);
+  
+  return true;
 }
 
-static uint16_t getImageHypotenuse(uint32_t imageResourceId) {
-  uint16_t hypotenuse = 0;
+void FrameSchedulerRemove(FrameCallback callback, void *context) {
+  FrameEntry *entry = findFrameEntry(callback, context);
+  if (entry != NULL) {
+    memset(entry, 0, sizeof(FrameEntry));
+    scheduleFrame(NowMs());
+  }
+}
+
+bool FrameSchedulerIsPending(FrameCallback callback, void *context) {
+  return (findFrameEntry(callback, context) != NULL);
+}
+
+void DestroyFrameScheduler() {
+  if (_frameTimer != NULL) {
+    app_timer_cancel(_frameTimer);
+    _frameTimer = NULL;
+  }
   
-  switch (imageResourceId) {
-    case RESOURCE_ID_IMAGE_DUCK:
-    case RESOURCE_ID_IMAGE_DUCK_LEFT:
-      hypotenuse = 36;
-      break;
+  memset(_frameEntries, 0, sizeof(_frameEntries));
+}
+
+// Adds callback to the minute transition, the one animation that carries the water and
+// whatever rides on it to the new minute's place, so they all move in the same update.
+// The first callback added starts it and others added before its first frame join it.
+// Returns the transition's animation, or NULL if it has already begun moving or there is
+// no room, in which case the caller moves on its own. stopped, if not NULL, is called
+// with the animation and context when the transition stops.
+Animation* MinuteTransitionAdd(TransitionCallback callback, AnimationStoppedHandler stopped, void *context) {
+  if (_transition == NULL) {
+    _transition = animation_create();
+    if (_transition == NULL) {
+      return NULL;
+    }
+  }
+  
+  bool scheduled = animation_is_scheduled(_transition);
+  if (scheduled == false) {
+    memset(_transitionEntries, 0, sizeof(_transitionEntries));
+    _transitionMoving = false;
     
-    case RESOURCE_ID_IMAGE_DUCK_DIVE:
-      hypotenuse = 41;
-      break;
+  } else if (_transitionMoving) {
+    return NULL;
+  }
+  
+  TransitionEntry *entry = findTransitionEntry(NULL, NULL);
+  if (entry == NULL) {
+    return NULL;
+  }
+  
+  entry->callback = callback;
+  entry->stopped = stopped;
+  entry->context = context;
+  
+  if (scheduled == false) {
+    animation_set_duration(_transition, WATER_RISE_DURATION);
+    animation_set_curve(_transition, AnimationCurveLinear);
+    animation_set_delay(_transition, 0);
     
-    case RESOURCE_ID_IMAGE_DUCK_LANDING:
-    case RESOURCE_ID_IMAGE_DUCK_LANDING_LEFT:
-      hypotenuse = 59;
-      break;
+    // Set on every run, as the profiler hands the animation its implementation and
+    // handlers back when it stops.
+    animation_set_implementation(_transition, &_minuteTransitionImplementation);
+    animation_set_handlers(_transition, (AnimationHandlers) {
+      .started = NULL,
+      .stopped = minuteTransitionStopped,
+    }, NULL);
     
-    case RESOURCE_ID_IMAGE_DUCK_TAKING_OFF:
-    case RESOURCE_ID_IMAGE_DUCK_TAKING_OFF_LEFT:
-      hypotenuse = 68;
-      break;
+    animation_schedule(_transition);
+  }
+  
+  return _transition;
+}
+
+// Removes callback from the minute transition, calling its stopped handler as unfinished
+// the way unscheduling an animation would. The transition stops when nothing is left on
+// it.
+void MinuteTransitionRemove(TransitionCallback callback, void *context) {
+  TransitionEntry *entry = findTransitionEntry(callback, context);
+  if (entry == NULL) {
+    return;
+  }
+  
+  AnimationStoppedHandler stopped = entry->stopped;
+  memset(entry, 0, sizeof(TransitionEntry));
+  if (stopped != NULL) {
+    stopped(_transition, false, context);
+  }
+  
+  for (uint16_t index = 0; index < MAX_TRANSITION_CALLBACKS; index++) {
+    if (_transitionEntries[index].callback != NULL) {
+      return;
+    }
+  }
+  
+  animation_unschedule(_transition);
+}
+
+void DestroyMinuteTransition() {
+  memset(_transitionEntries, 0, sizeof(_transitionEntries));
+  
+  if (_transition != NULL) {
+    animation_unschedule(_transition);
+    animation_destroy(_transition);
+    _transition = NULL;
+  }
+}
+
+void SetPowerTier(PowerTier tier) {
+  _powerTier = tier;
+}
+
+// Whether purely decorative animations such as bubbles, hearts and passes may run.
+bool DecorationsAllowed() {
+  return (_powerTier == POWER_FULL);
+}
+
+// Whether objects may animate to their new place rather than jump straight to it.
+bool TransitionsAllowed() {
+  return (_powerTier < POWER_LOW);
+}
+
+static void frameAnimationUpdate(Animation *animation, const uint32_t distance_normalized) {
+  FrameAnimation *frameAnimation = (FrameAnimation*) animation_get_context(animation);
+  GRect from = frameAnimation->from;
+  GRect to = frameAnimation->to;
+  int32_t distance = (int32_t) distance_normalized;
+  
+  layer_set_frame(frameAnimation->layer, GRect(
+    from.origin.x + ((to.origin.x - from.origin.x) * distance / ANIMATION_NORMALIZED_MAX),
+    from.origin.y + ((to.origin.y - from.origin.y) * distance / ANIMATION_NORMALIZED_MAX),
+    from.size.w + ((to.size.w - from.size.w) * distance / ANIMATION_NORMALIZED_MAX),
+    from.size.h + ((to.size.h - from.size.h) * distance / ANIMATION_NORMALIZED_MAX)));
+}
+
+// Frames fall on multiples of the interval on the watch clock, so a callback due every
+// 100ms always runs in the same wakeup as one due every 50ms.
+static uint32_t nextFrameDue(uint32_t now, uint16_t intervalMs) {
+  return now - (now % intervalMs) + intervalMs;
+}
+
+// Sets the timer for the earliest callback due, or stops it if none is pending.
+static void scheduleFrame(uint32_t now) {
+  FrameEntry *earliest = NULL;
+  for (uint16_t index = 0; index < MAX_FRAME_CALLBACKS; index++) {
+    FrameEntry *entry = &_frameEntries[index];
+    if (entry->callback != NULL && (earliest == NULL || (int32_t) (entry->dueMs - earliest->dueMs) < 0)) {
+      earliest = entry;
+    }
+  }
+  
+  if (earliest == NULL) {
+    if (_frameTimer != NULL) {
+      app_timer_cancel(_frameTimer);
+      _frameTimer = NULL;
+    }
     
-    case RESOURCE_ID_IMAGE_TURKEY:
-    case RESOURCE_ID_IMAGE_TURKEY_LEFT:
-      hypotenuse = 42;
-      break;
+    return;
+  }
+  
+  if (_frameTimer != NULL && _frameDueMs == earliest->dueMs) {
+    return;
+  }
+  
+  uint32_t delayMs = ((int32_t) (earliest->dueMs - now) > 0) ? earliest->dueMs - now : 0;
+  if (_frameTimer == NULL || app_timer_reschedule(_frameTimer, delayMs) == false) {
+    _frameTimer = app_timer_register(delayMs, (AppTimerCallback) frameTimerCallback, NULL);
+  }
+  
+  _frameDueMs = earliest->dueMs;
+}
+
+static void frameTimerCallback(void *callback_data) {
+  _frameTimer = NULL;
+  uint32_t now = NowMs();
+  
+  // Callbacks may add and remove entries. Ones added during this frame are not due yet.
+  for (uint16_t index = 0; index < MAX_FRAME_CALLBACKS; index++) {
+    FrameEntry *entry = &_frameEntries[index];
+    if (entry->callback == NULL || (int32_t) (entry->dueMs - now) > 0) {
+      continue;
+    }
     
-    default:
-      break;
+    FrameCallback callback = entry->callback;
+    void *context = entry->context;
+    uint32_t elapsedMs = now - entry->lastMs;
+    entry->lastMs = now;
+    entry->dueMs = nextFrameDue(now, entry->intervalMs);
+    
+    if (callback(context, elapsedMs) == false && entry->callback == callback && entry->context == context) {
+      memset(entry, 0, sizeof(FrameEntry));
+    }
+  }
+  
+  scheduleFrame(now);
+}
+
+static FrameEntry* findFrameEntry(FrameCallback callback, void *context) {
+  for (uint16_t index = 0; index < MAX_FRAME_CALLBACKS; index++) {
+    if (_frameEntries[index].callback == callback && _frameEntries[index].context == context) {
+      return &_frameEntries[index];
+    }
+  }
+  
+  return NULL;
+}
+
+static void minuteTransitionUpdate(Animation *animation, const uint32_t distance_normalized) {
+  _transitionMoving = true;
+  
+  for (uint16_t index = 0; index < MAX_TRANSITION_CALLBACKS; index++) {
+    TransitionEntry *entry = &_transitionEntries[index];
+    if (entry->callback != NULL) {
+      entry->callback(entry->context, distance_normalized);
+    }
+  }
+}
+
+// The entries are cleared before the stopped handlers run, so a handler can start the
+// next transition.
+static void minuteTransitionStopped(Animation *animation, bool finished, void *context) {
+  TransitionEntry entries[MAX_TRANSITION_CALLBACKS];
+  memcpy(entries, _transitionEntries, sizeof(entries));
+  memset(_transitionEntries, 0, sizeof(_transitionEntries));
+  _transitionMoving = false;
+  
+  for (uint16_t index = 0; index < MAX_TRANSITION_CALLBACKS; index++) {
+    if (entries[index].stopped != NULL) {
+      entries[index].stopped(animation, finished, entries[index].context);
+    }
+  }
+}
+
+static TransitionEntry* findTransitionEntry(TransitionCallback callback, void *context) {
+  for (uint16_t index = 0; index < MAX_TRANSITION_CALLBACKS; index++) {
+    if (_transitionEntries[index].callback == callback && _transitionEntries[index].context == context) {
+      return &_transitionEntries[index];
+    }
+  }
+  
+  return NULL;
+}
+
+static void bitmapGroupUpdateProc(Layer *layer, GContext *ctx) {
+  const GBitmap *bitmap = *(const GBitmap**) layer_get_data(layer);
+  if (bitmap == NULL) {
+    return;
+  }
+  
+  GBitmap *framebuffer = graphics_capture_frame_buffer(ctx);
+  if (framebuffer == NULL) {
+    return;
+  }
+  
+  BlitSpriteAnd(framebuffer, bitmap, layer_get_frame(layer).origin);
+  graphics_release_frame_buffer(ctx, framebuffer);
+}
+
+// Lets go of the current rendering before acquiring the next one, so that when nothing
+// else holds it the cache renders over it instead of allocating another. Nothing draws
+// in between, so the layer is never drawn with a released rendering.
+static void showRotatedBitmap(RotBitmapGroup *group) {
+  if (group->rotated != NULL) {
+    RotationCacheRelease(group->rotated);
   }
   
-  return hypotenuse;
+  group->rotated = (group->bitmap != NULL) ? RotationCacheAcquire(group->resourceId, group->angle) : NULL;
+  bitmap_layer_set_bitmap(group->layer, group->rotated);
 }
\ No newline at end of file
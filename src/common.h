@@ -1,7 +1,10 @@
 #pragma once
 
+#include "sprite_metrics.auto.h"
+
 //#define RUN_TEST true
 //#define LOGGING_ON true
+//#define PROFILING_ON true
   
 #define INSTALLED_VERSION 18
 
@@ -37,7 +40,12 @@
 #define PEBBLE_ANGLE_FROM_DEGREE(degree) (degree * PEBBLE_ANGLE_PER_DEGREE)
 
 // Convert from minute to Y coordinate
-#define WATER_TOP(minute) (SCREEN_HEIGHT - (minute * 14 / 5))
+#define WATER_TOP(minute) (Keyframes[minute].waterTop)
+
+#define KEYFRAME_COUNT 60
+
+// The largest GetImageHypotenuse() of any image that is drawn rotated.
+#define MAX_IMAGE_HYPOTENUSE IMAGE_DUCK_TAKING_OFF_HYPOTENUSE
   
 #ifdef LOGGING_ON
   #define MY_APP_LOG(level, fmt, args...)                                \
@@ -46,26 +54,110 @@
   #define MY_APP_LOG(level, fmt, args...)
 #endif
 
-typedef enum { CHILD, ABOVE_SIBLING, BELOW_SIBLING } LayerRelation;
 typedef enum { UNDEFINED_SCENE, DUCK, THANKSGIVING, CHRISTMAS, FRIDAY13, VALENTINES } SCENE;
 
+// Route layer drawing and animations through the profiler, see profiler.h.
+#ifdef PROFILING_ON
+  #include "profiler.h"
+  #define layer_set_update_proc(layer, update_proc)                       \
+    ProfileSetUpdateProc(layer, update_proc, #update_proc)
+  #define layer_destroy(layer) ProfileDestroyLayer(layer)
+  #define animation_set_handlers(animation, args...)                      \
+    ProfileSetAnimationHandlers(animation, args, __FILE_NAME__)
+  #define animation_schedule(animation)                                   \
+    ProfileScheduleAnimation(animation, __FILE_NAME__)
+  #define PROFILE_HEAP(name, statement)                                   \
+    do { ProfileHeapBegin(name); statement; ProfileHeapEnd(name); } while (0)
+#else
+  #define PROFILE_HEAP(name, statement) statement
+#endif
+
+// Frame scheduler cadence. Frames fall on multiples of FRAME_INTERVAL milliseconds of the
+// watch clock, and all per-frame work due at the same time shares the one wakeup.
+#define FRAME_INTERVAL 50
+#define MAX_FRAME_CALLBACKS 8
+
+// Layers that can ride one minute transition together.
+#define MAX_TRANSITION_CALLBACKS 4
+
+typedef enum { CHILD, ABOVE_SIBLING, BELOW_SIBLING } LayerRelation;
+
+// How much animation the battery can afford, set by main.c from the charge level. Each
+// tier drops what the tiers above it drop. POWER_SAVING stops bubbles, hearts and the
+// shark and santa passes, and POWER_LOW also puts the duck, water and waves in place
+// instead of animating them.
+typedef enum { POWER_FULL, POWER_SAVING, POWER_LOW } PowerTier;
+
+// An image drawn by the sprite blitter the way a BitmapLayer with GCompOpAnd would draw
+// it. The layer's frame is where the image is on the screen, so its parent must be at
+// the top left of the screen.
 typedef struct {
-  BitmapLayer *layer;
+  Layer *layer;
   GBitmap *bitmap;
   uint32_t resourceId;
 } BitmapGroup;
 
+// An image shown at an angle. The layer draws the rendering from the rotation cache.
 typedef struct {
-  RotBitmapLayer *layer;
+  BitmapLayer *layer;
   GBitmap *bitmap;
   uint32_t resourceId;
   int32_t angle;        // Angle in degrees
+  GBitmap *rotated;     // The image rendered at angle
 } RotBitmapGroup;
 
+// A layer frame animation created once with its layer and retargeted for every move, so
+// moves don't create and destroy an animation each time. Between RetargetFrameAnimation
+// and animation_schedule the caller sets the duration, delay and curve of the move.
+typedef struct {
+  Animation *animation;
+  Layer *layer;
+  GRect from;
+  GRect to;
+} FrameAnimation;
+
+// Where everything sits in a minute of the hour. Generated into keyframes.auto.c by
+// tools/gen_keyframes.py.
+typedef struct {
+  GPoint duckPoint;       // Bottom center of the duck sitting on the wave
+  bool duckMovingRight;
+  int16_t waterTop;
+  int16_t sharkPassY;     // Y coordinate of the shark's pass
+  int16_t santaPassY;     // Y coordinate Santa's fly-by starts at
+} Keyframe;
+
+extern const Keyframe Keyframes[KEYFRAME_COUNT];
+
+// Called once per interval with the milliseconds since it was last called, or since it
+// was added. Returns false to stop being called.
+typedef bool (*FrameCallback)(void *context, uint32_t elapsedMs);
+
+// Called on every frame of the minute transition with its progress, from 0 to
+// ANIMATION_NORMALIZED_MAX.
+typedef void (*TransitionCallback)(void *context, uint32_t progress);
+
 void AddLayer(Layer *relativeLayer, Layer *newLayer, LayerRelation relation);
 void SetLayerHidden(Layer *layer, bool *currentHidden, bool newHidden);
+void InitBitmapGroup(BitmapGroup *group, GRect frame);
 bool BitmapGroupSetBitmap(BitmapGroup *group, uint32_t imageResourceId);
+void BitmapGroupShowBitmap(BitmapGroup *group, const GBitmap *bitmap);
 GRect RotBitmapGroupChangeBitmap(RotBitmapGroup *group, uint32_t imageResourceId);
+void RotBitmapGroupSetAngle(RotBitmapGroup *group, int32_t angle);
 void DestroyBitmapGroup(BitmapGroup *group);
 void DestroyRotBitmapGroup(RotBitmapGroup *group);
-bool isBufferFull(uint16_t start, uint16_t end, uint16_t size);
+void InitFrameAnimation(FrameAnimation *frameAnimation, Layer *layer);
+bool RetargetFrameAnimation(FrameAnimation *frameAnimation, GRect to);
+bool FrameAnimationIsRunning(FrameAnimation *frameAnimation);
+void DestroyFrameAnimation(FrameAnimation *frameAnimation);
+uint16_t GetImageHypotenuse(uint32_t imageResourceId);
+uint32_t NowMs();
+bool FrameSchedulerAdd(FrameCallback callback, void *context, uint16_t intervalMs);
+void FrameSchedulerRemove(FrameCallback callback, void *context);
+bool FrameSchedulerIsPending(FrameCallback callback, void *context);
+void DestroyFrameScheduler();
+Animation* MinuteTransitionAdd(TransitionCallback callback, AnimationStoppedHandler stopped, void *context);
+void MinuteTransitionRemove(TransitionCallback callback, void *context);
+void DestroyMinuteTransition();
+void SetPowerTier(PowerTier tier);
+bool DecorationsAllowed();
+bool TransitionsAllowed();
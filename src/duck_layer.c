@@ -1,7 +1,7 @@
 #include <pebble.h>
 #include "duck_layer.h"
+#include "bitmap_cache.h"
 
-#define HORIZONTAL_POSITIONS 15
 #define DIVE_POSITIONS 7
 #define BEGIN_DIVE_MINUTE 53
 #define SHARK_SCENE_HIDE_DUCK_MINUTE 52
@@ -26,15 +26,14 @@
 // Second past minute 59 that the bubbles should not start.
 #define BUBBLES_CUTOFF_SECOND 59
   
-// Milliseconds between each rotation increment when duck is starting dive.
-#define ROTATION_INCREMENT_DURATION 50
-
 typedef enum { DISPLAY_NONE, DISPLAY_ANIMATION, DISPLAY_DIVE, DISPLAY_FLY_IN } DISPLAY_ACTION;
 
+// Angles the duck turns between over the course of its animation.
 typedef struct {
-  int32_t startAngle;  // Start angle in degrees
-  int32_t endAngle;    // End angle in degrees
-  int32_t increment;   // Degrees to rotate per increment
+  int32_t startAngle;         // Start angle in degrees
+  int32_t endAngle;           // End angle in degrees
+  bool clockwise;             // Turn with increasing angles
+  uint16_t degreesPerSecond;  // Turns at this speed from the start of the move, or along the move if 0
 } RotationAnimation;
 
 typedef struct {
@@ -48,45 +47,51 @@ typedef struct {
   AnimationCurve animationCurve;
   AnimationStoppedHandler animationStoppedHandler;
   RotationAnimation rotation;
+  bool withWater;     // Rides the water's rise on the minute transition
 } DuckAnimation;
 
-static int16_t _duckCoordinateX[HORIZONTAL_POSITIONS] = { 17, 25, 32, 40, 48, 56, 63, 71, 79, 86, 94, 102, 110, 117, 125 };
+// The running move. Position and angle are both worked out from the animation's
+// progress so they stay together.
+typedef struct {
+  GRect startFrame;
+  GRect endFrame;
+  int32_t startAngle;
+  int32_t rotation;   // Degrees to turn, negative to turn with decreasing angles
+  uint32_t turnMs;    // Duration of the turn, or 0 to turn along the move
+  uint32_t startMs;   // When the move's first frame was drawn
+  bool started;
+} DuckMove;
 
-// Pixels to offset the duck in the positive Y direction to make the duck look like
-// it is comfortably sitting on the wave.
-static int16_t _waveOffsetY[HORIZONTAL_POSITIONS] = { 1, 1, 4, 3, 1, 1, 2, 4, 2, 1, 1, 3, 4, 2, 1 };
 static GSize _bubbleOffset = { 8, 12 };
 
-static PropertyAnimation *_animation = NULL;
-static AppTimer *_rotationTimer = NULL;
-static int32_t _rotationAmount = 0;
-static int32_t _rotationIncrement = 0;
-static AppTimer *_flyInTimer = NULL;
-static AppTimer *_flyOutTimer = NULL;
+static Animation *_animation = NULL;
+static DuckMove _move;
+static bool _flyInPending = false;
+static bool _flyOutPending = false;
 static AppTimer *_heartTimer = NULL;
 
-static PropertyAnimation* runAnimation(DuckLayerData *data, DuckAnimation *duckAnimation, uint16_t minute);
-static DuckAnimation* getAnimation(uint16_t minute, SCENE scene);
-static DuckAnimation* getDiveAnimation(uint16_t minute);
-static DuckAnimation* getFlyInAnimation(uint16_t minute);
-static DuckAnimation* getFlyOutAnimation(uint16_t minute);
+static Animation* runAnimation(DuckLayerData *data, DuckAnimation *duckAnimation, uint16_t minute);
+static void moveAnimationUpdate(Animation *animation, const uint32_t distance_normalized);
+static void moveTransitionUpdate(void *context, uint32_t progress);
+static void setMoveProgress(DuckLayerData *data, int32_t progress);
+static void setDuckAngle(DuckLayerData *data, int32_t angle);
+static bool getAnimation(uint16_t minute, SCENE scene, DuckAnimation *duckAnimation);
+static bool getDiveAnimation(uint16_t minute, DuckAnimation *duckAnimation);
+static void getFlyInAnimation(uint16_t minute, DuckAnimation *duckAnimation);
+static void getFlyOutAnimation(uint16_t minute, DuckAnimation *duckAnimation);
 static DISPLAY_ACTION getDisplayAction(DuckLayerData *data, uint16_t minute, uint16_t second, bool firstDisplay);
 static bool canDoFlyOut(DuckLayerData *data, uint16_t minute, uint16_t second, int16_t *flyInMinute, uint32_t *flyInDelay);
 static uint32_t getDuckResourceId(uint16_t minute, SCENE scene);
 static bool isAnimationInProgress();
 static void disableAnimations(DuckAnimation *duckAnimation);
-static GPoint getDuckWavePoint(uint16_t minute);
-static uint16_t getHorizontalPosition(uint16_t minute);
 static GRect getFrameFromPoint(GPoint bottomCenter, int16_t width, int16_t height);
-static bool isMovingRight(uint16_t minute);
 static bool isSharkSceneControl(SCENE scene, uint16_t minute);
 static void resolveCoordinateSubstitution(GPoint *point, uint16_t objectWidth, uint16_t minute);
 static void moveAnimationStopped(Animation *animation, bool finished, void *context);
 static void flyInAnimationStopped(Animation *animation, bool finished, void *context);
 static void flyOutAnimationStopped(Animation *animation, bool finished, void *context);
-static void flyInFinishedTimerCallback(void *callback_data);
-static void flyOutFinishedTimerCallback(void *callback_data);
-static void rotationTimerCallback(void *callback_data);
+static bool flyInFinishedFrameCallback(void *context, uint32_t elapsedMs);
+static bool flyOutFinishedFrameCallback(void *context, uint32_t elapsedMs);
 static void heartTimerCallback(void *callback_data);
 static uint32_t calcDegreeDiff(int32_t startDegree, int32_t endDegree, bool rotateCW);
 static void addBubbles(DuckLayerData *data);
@@ -95,44 +100,48 @@ static void addHearts(DuckLayerData *data);
 static DuckAnimation _duckDiveAnimation[DIVE_POSITIONS] = {
   { 
     RESOURCE_ID_IMAGE_DUCK_LEFT, { PREVIOUS_COORD, PREVIOUS_COORD }, { 63, 35 }, WATER_RISE_DURATION, 0, AnimationCurveLinear, moveAnimationStopped, 
-    {0, 300, -5}
+    {0, 300, false, 0}, true
   },
   { 
     RESOURCE_ID_IMAGE_DUCK_DIVE, { 59, 39 }, { 48, 60 }, DIVE_DURATION, 0, AnimationCurveEaseInOut, moveAnimationStopped, 
-    {24, 20, -1}
+    {24, 20, false, 20}, false
   },
   { 
     RESOURCE_ID_IMAGE_DUCK_DIVE, { 48, 60 }, { 38, 82 }, DIVE_DURATION, 0, AnimationCurveEaseInOut, moveAnimationStopped, 
-    {20, 20, 0}
+    {20, 20, false, 0}, false
   },
   { 
     RESOURCE_ID_IMAGE_DUCK_DIVE, { 38, 82 }, { 32, 105 }, DIVE_DURATION, 0, AnimationCurveEaseInOut, moveAnimationStopped, 
-    {20, 0, -1}
+    {20, 0, false, 20}, false
   },
   { 
     RESOURCE_ID_IMAGE_DUCK_DIVE, { 32, 105 }, { 28, 130 }, DIVE_DURATION, 0, AnimationCurveEaseInOut, moveAnimationStopped, 
-    {0, 0, 0}
+    {0, 0, false, 0}, false
   },
   { 
     RESOURCE_ID_IMAGE_DUCK_DIVE, { 28, 130 }, { 24, 155 }, DIVE_DURATION, 0, AnimationCurveEaseInOut, moveAnimationStopped, 
-   {0, 0, 0}
+   {0, 0, false, 0}, false
   },
   { 
     RESOURCE_ID_IMAGE_DUCK_DIVE, { 24, 155 }, { 20, 180 }, DIVE_DURATION, 0, AnimationCurveEaseInOut, moveAnimationStopped, 
-    {0, 0, 0}
+    {0, 0, false, 0}, false
   }
 };
 
+static const AnimationImplementation _moveImplementation = {
+  .update = moveAnimationUpdate,
+};
+
 DuckLayerData* CreateDuckLayer(Layer* relativeLayer, LayerRelation relation, SCENE scene) {
   DuckLayerData* data = malloc(sizeof(DuckLayerData));
   if (data != NULL) {
     memset(data, 0, sizeof(DuckLayerData));
-    data->duck.bitmap = gbitmap_create_with_resource(RESOURCE_ID_IMAGE_DUCK);
-    data->duck.resourceId = RESOURCE_ID_IMAGE_DUCK;
-    data->duck.layer = rot_bitmap_layer_create(data->duck.bitmap);
-    rot_bitmap_set_compositing_mode(data->duck.layer, GCompOpAnd);
+    data->duck.layer = bitmap_layer_create(GRect(0, 0, 0, 0));
+    bitmap_layer_set_compositing_mode(data->duck.layer, GCompOpAnd);
     AddLayer(relativeLayer, (Layer*) data->duck.layer, relation);
     data->duck.angle = 0;
+    RotBitmapGroupChangeBitmap(&data->duck, RESOURCE_ID_IMAGE_DUCK);
+    data->moveAnimation = animation_create();
     data->hidden = false;
     data->lastUpdateMinute = -1;
     data->exited = false;
@@ -172,33 +181,35 @@ void DrawDuckLayer(DuckLayerData* data, uint16_t hour, uint16_t minute, uint16_t
   }
   
   DISPLAY_ACTION displayAction = getDisplayAction(data, minute, second, firstDisplay);
-  DuckAnimation *duckAnimation = NULL;
+  DuckAnimation duckAnimation;
+  bool animate = false;
   if (displayAction == DISPLAY_NONE) {
     // Hide layer and exit if not displaying content
     SetLayerHidden((Layer*) data->duck.layer, &data->hidden, true);
     
   } else if (displayAction == DISPLAY_ANIMATION) {
-    duckAnimation = getAnimation(minute, data->scene);
+    animate = getAnimation(minute, data->scene, &duckAnimation);
     
   } else if (displayAction == DISPLAY_DIVE) {
-    duckAnimation = getDiveAnimation(minute);
+    animate = getDiveAnimation(minute, &duckAnimation);
     
   } else if  (displayAction == DISPLAY_FLY_IN) {
-    duckAnimation = getFlyInAnimation(minute);
-    duckAnimation->delay = firstDisplay ? FIRST_DISPLAY_ANIMATION_DELAY : 0;
+    getFlyInAnimation(minute, &duckAnimation);
+    duckAnimation.delay = firstDisplay ? FIRST_DISPLAY_ANIMATION_DELAY : 0;
+    animate = true;
   } 
    
-  if (duckAnimation == NULL) {
+  if (animate == false) {
     return;
   }
   
-  // If first display or minute zero and we're not doing the fly-in, don't do animations.
-  if ((firstDisplay || minute == 0) && displayAction != DISPLAY_FLY_IN) {
-    disableAnimations(duckAnimation);
+  // If first display or minute zero and we're not doing the fly-in, or the battery is
+  // low, don't do animations.
+  if (((firstDisplay || minute == 0) && displayAction != DISPLAY_FLY_IN) || TransitionsAllowed() == false) {
+    disableAnimations(&duckAnimation);
   }
   
-  _animation = runAnimation(data, duckAnimation, minute);
-  free(duckAnimation);
+  _animation = runAnimation(data, &duckAnimation, minute);
   
   // The shark layer controls the duck visibility during the SHARK_SCENE_EAT_MINUTE minute.
   if (isSharkSceneControl(data->scene, minute) == false) {
@@ -206,38 +217,40 @@ void DrawDuckLayer(DuckLayerData* data, uint16_t hour, uint16_t minute, uint16_t
   }
   
   // For Valentine's Day draw hearts on first display.
-  if (data->heartData != NULL && firstDisplay && second < BUBBLES_CUTOFF_SECOND) {
+  if (data->heartData != NULL && firstDisplay && second < BUBBLES_CUTOFF_SECOND && DecorationsAllowed()) {
       _heartTimer = app_timer_register(FIRST_DISPLAY_ANIMATION_DELAY, (AppTimerCallback) heartTimerCallback, (void*) data);
   }
 }
 
 void DestroyDuckLayer(DuckLayerData* data) {
-  if (_rotationTimer != NULL) {
-    app_timer_cancel(_rotationTimer);
-    _rotationTimer = NULL;
-  }
+  FrameSchedulerRemove(flyInFinishedFrameCallback, data);
+  FrameSchedulerRemove(flyOutFinishedFrameCallback, data);
+  MinuteTransitionRemove(moveTransitionUpdate, data);
+  _flyInPending = false;
+  _flyOutPending = false;
   
   if (_heartTimer != NULL) {
     app_timer_cancel(_heartTimer);
     _heartTimer = NULL;
   }
   
-  if (_flyInTimer != NULL) {
-    app_timer_cancel(_flyInTimer);
-    _flyInTimer = NULL;
-  }
-  
   if (data != NULL) {    
     if (data->bubbleData != NULL) {
-      DestroyBubbleLayer(data->bubbleData);    
+      PROFILE_HEAP("bubbles", DestroyBubbleLayer(data->bubbleData));    
       data->bubbleData = NULL;
     }
     
     if (data->heartData != NULL) {
-      DestroyHeartLayer(data->heartData);    
+      PROFILE_HEAP("hearts", DestroyHeartLayer(data->heartData));    
       data->heartData = NULL;
     }
     
+    if (data->moveAnimation != NULL) {
+      animation_unschedule(data->moveAnimation);
+      animation_destroy(data->moveAnimation);
+      data->moveAnimation = NULL;
+    }
+    
     DestroyRotBitmapGroup(&data->duck);
     free(data);
   }
@@ -248,18 +261,18 @@ void SwitchSceneDuckLayer(DuckLayerData* data, SCENE scene) {
   bool heartLayer = (scene == VALENTINES);
   
   if (bubbleLayer == true && data->bubbleData == NULL) {
-    data->bubbleData = CreateBubbleLayer((Layer*) data->duck.layer, ABOVE_SIBLING);
+    PROFILE_HEAP("bubbles", data->bubbleData = CreateBubbleLayer((Layer*) data->duck.layer, ABOVE_SIBLING));
     
   } else if (bubbleLayer == false && data->bubbleData != NULL) {
-    DestroyBubbleLayer(data->bubbleData);
+    PROFILE_HEAP("bubbles", DestroyBubbleLayer(data->bubbleData));
     data->bubbleData = NULL;
   }
   
   if (heartLayer == true && data->heartData == NULL) {
-    data->heartData = CreateHeartLayer((Layer*) data->duck.layer, ABOVE_SIBLING);
+    PROFILE_HEAP("hearts", data->heartData = CreateHeartLayer((Layer*) data->duck.layer, ABOVE_SIBLING));
     
   } else if (heartLayer == false && data->heartData != NULL) {
-    DestroyHeartLayer(data->heartData);
+    PROFILE_HEAP("hearts", DestroyHeartLayer(data->heartData));
     data->heartData = NULL;
   }
   
@@ -276,10 +289,8 @@ void HandleTapDuckLayer(DuckLayerData *data, uint16_t hour, uint16_t minute, uin
   int16_t flyInMinute = -1;
   uint32_t flyInDelay = 0;
   if (canDoFlyOut(data, minute, second, &flyInMinute, &flyInDelay)) {
-    DuckAnimation *duckAnimation = getFlyOutAnimation(minute);
-    if (duckAnimation == NULL) {
-      return;
-    }
+    DuckAnimation duckAnimation;
+    getFlyOutAnimation(minute, &duckAnimation);
     
     // Set whether duck is coming back.
     data->exited = (flyInMinute == -1);
@@ -288,11 +299,10 @@ void HandleTapDuckLayer(DuckLayerData *data, uint16_t hour, uint16_t minute, uin
       data->flyInDelayAnimation = flyInDelay;
     }
     
-    _animation = runAnimation(data, duckAnimation, minute);
-    free(duckAnimation);
+    _animation = runAnimation(data, &duckAnimation, minute);
     
-  } else if ((minute == 59 && second >= BUBBLES_CUTOFF_SECOND) == false) {
-    // Don't add bubbles or hearts if hour is about to change.
+  } else if ((minute == 59 && second >= BUBBLES_CUTOFF_SECOND) == false && DecorationsAllowed()) {
+    // Don't add bubbles or hearts if hour is about to change or the battery is saving.
     if (data->bubbleData != NULL) {
       addBubbles(data);
       
@@ -302,8 +312,8 @@ void HandleTapDuckLayer(DuckLayerData *data, uint16_t hour, uint16_t minute, uin
   }
 }
 
-static PropertyAnimation* runAnimation(DuckLayerData *data, DuckAnimation *duckAnimation, uint16_t minute) {
-  PropertyAnimation *animation = NULL;
+static Animation* runAnimation(DuckLayerData *data, DuckAnimation *duckAnimation, uint16_t minute) {
+  Animation *animation = NULL;
   GRect rotLayerFrame;
   if (duckAnimation->resourceId != data->duck.resourceId) {
     rotLayerFrame = RotBitmapGroupChangeBitmap(&data->duck, duckAnimation->resourceId);
@@ -312,29 +322,20 @@ static PropertyAnimation* runAnimation(DuckLayerData *data, DuckAnimation *duckA
     rotLayerFrame = layer_get_frame((Layer*) data->duck.layer);   
   }
   
+  if (data->duck.bitmap == NULL) {
+    return NULL;
+  }
+  
   resolveCoordinateSubstitution(&duckAnimation->endPoint, data->duck.bitmap->bounds.size.w, minute);
   GRect endFrame = getFrameFromPoint(duckAnimation->endPoint, rotLayerFrame.size.w, rotLayerFrame.size.h);
   
   // Offset the frame by the buffer the RotBitmapLayer creates around the bitmap.
   endFrame.origin.y += ((rotLayerFrame.size.h - data->duck.bitmap->bounds.size.h) / 2);
   
-  // No rotation animation, so check that duck is set to end angle
-  if (duckAnimation->rotation.increment == 0) {
-    if (data->duck.angle != duckAnimation->rotation.endAngle) {
-      rot_bitmap_layer_set_angle(data->duck.layer, PEBBLE_ANGLE_FROM_DEGREE(duckAnimation->rotation.endAngle));
-      data->duck.angle = duckAnimation->rotation.endAngle;
-    }
-  } else if (_rotationTimer == NULL) {
-    if (data->duck.angle != duckAnimation->rotation.startAngle) {
-      rot_bitmap_layer_set_angle(data->duck.layer, PEBBLE_ANGLE_FROM_DEGREE(duckAnimation->rotation.startAngle));
-      data->duck.angle = duckAnimation->rotation.startAngle;
-    }
-    
-    _rotationAmount = calcDegreeDiff(duckAnimation->rotation.startAngle, duckAnimation->rotation.endAngle, 
-                                     (duckAnimation->rotation.increment > 0));
-    
-    _rotationIncrement = duckAnimation->rotation.increment;
-    _rotationTimer = app_timer_register(ROTATION_INCREMENT_DURATION, (AppTimerCallback) rotationTimerCallback, (void*) data);
+  // Without a move, or a turn, the duck goes straight to its end angle.
+  RotationAnimation *rotation = &duckAnimation->rotation;
+  if (duckAnimation->duration == 0 || rotation->startAngle == rotation->endAngle) {
+    setDuckAngle(data, rotation->endAngle);
   }
 
   if (duckAnimation->duration == 0) {
@@ -348,73 +349,88 @@ static PropertyAnimation* runAnimation(DuckLayerData *data, DuckAnimation *duckA
     startFrame.origin.y += ((rotLayerFrame.size.h - data->duck.bitmap->bounds.size.h) / 2);
     layer_set_frame((Layer*) data->duck.layer, startFrame);
     
-    // Create the animation and schedule it.
-    animation = property_animation_create_layer_frame((Layer*) data->duck.layer, NULL, &endFrame);
-    animation_set_duration((Animation*) animation, duckAnimation->duration);
-    animation_set_curve((Animation*) animation, duckAnimation->animationCurve);
-    animation_set_delay((Animation*) animation, duckAnimation->delay);
-    animation_set_handlers((Animation*) animation, (AnimationHandlers) {
-      .started = NULL,
-      .stopped = (AnimationStoppedHandler) duckAnimation->animationStoppedHandler,
-    }, (void*) data);
-
-    animation_schedule((Animation*) animation);
+    _move.startFrame = startFrame;
+    _move.endFrame = endFrame;
+    _move.startAngle = rotation->startAngle;
+    _move.rotation = 0;
+    _move.turnMs = 0;
+    _move.started = false;
+    if (rotation->startAngle != rotation->endAngle) {
+      setDuckAngle(data, rotation->startAngle);
+      _move.rotation = calcDegreeDiff(rotation->startAngle, rotation->endAngle, rotation->clockwise);
+      if (rotation->degreesPerSecond > 0) {
+        _move.turnMs = (uint32_t) _move.rotation * 1000 / rotation->degreesPerSecond;
+      }
+      
+      if (rotation->clockwise == false) {
+        _move.rotation = 0 - _move.rotation;
+      }
+    }
+    
+    // A move riding the water goes on the minute transition so that the duck and the
+    // water move in the same update. Anything else, or a move that can't join the
+    // transition, retargets the layer's own animation and schedules it.
+    if (duckAnimation->withWater) {
+      animation = MinuteTransitionAdd(moveTransitionUpdate, duckAnimation->animationStoppedHandler, data);
+    }
+    
+    if (animation == NULL && data->moveAnimation != NULL) {
+      animation = data->moveAnimation;
+      animation_set_duration(animation, duckAnimation->duration);
+      animation_set_curve(animation, duckAnimation->animationCurve);
+      animation_set_delay(animation, duckAnimation->delay);
+      animation_set_implementation(animation, &_moveImplementation);
+      animation_set_handlers(animation, (AnimationHandlers) {
+        .started = NULL,
+        .stopped = (AnimationStoppedHandler) duckAnimation->animationStoppedHandler,
+      }, (void*) data);
+
+      animation_schedule(animation);
+    }
   }
   
   return animation;
 }
 
-static DuckAnimation* getAnimation(uint16_t minute, SCENE scene) {
+// The get*Animation functions fill in the caller's duckAnimation, the ones returning bool
+// return false if there is no animation for the minute.
+static bool getAnimation(uint16_t minute, SCENE scene, DuckAnimation *duckAnimation) {
   uint32_t duckResourceId = getDuckResourceId(minute, scene);
   if (duckResourceId == 0) {
-    return NULL;
-  }
-  
-  DuckAnimation *duckAnimation = malloc(sizeof(DuckAnimation));
-  if (duckAnimation == NULL) {
-    return NULL;
+    return false;
   }
   
   memset(duckAnimation, 0, sizeof(DuckAnimation));
   duckAnimation->resourceId = duckResourceId;
-  duckAnimation->endPoint = getDuckWavePoint(minute);
+  duckAnimation->endPoint = Keyframes[minute].duckPoint;
   if (minute > 0) {
     duckAnimation->startPoint = GPoint(PREVIOUS_COORD, PREVIOUS_COORD);    
     duckAnimation->duration = WATER_RISE_DURATION;
     duckAnimation->animationCurve = AnimationCurveLinear;
     duckAnimation->animationStoppedHandler = moveAnimationStopped;
+    duckAnimation->withWater = true;
   }
 
-  return duckAnimation;
+  return true;
 }
 
-static DuckAnimation* getDiveAnimation(uint16_t minute) {
+static bool getDiveAnimation(uint16_t minute, DuckAnimation *duckAnimation) {
   if (minute < BEGIN_DIVE_MINUTE) {
-    return NULL;
-  }
-  
-  DuckAnimation *duckAnimation = malloc(sizeof(DuckAnimation));
-  if (duckAnimation == NULL) {
-    return NULL;
+    return false;
   }
   
   memcpy(duckAnimation, &_duckDiveAnimation[minute - BEGIN_DIVE_MINUTE], sizeof(DuckAnimation));
-  return duckAnimation;
+  return true;
 }
 
-static DuckAnimation* getFlyInAnimation(uint16_t minute) {
-  DuckAnimation *duckAnimation = malloc(sizeof(DuckAnimation));
-  if (duckAnimation == NULL) {
-    return NULL;
-  }
-  
+static void getFlyInAnimation(uint16_t minute, DuckAnimation *duckAnimation) {
   memset(duckAnimation, 0, sizeof(DuckAnimation));
-  duckAnimation->endPoint = getDuckWavePoint(minute);
+  duckAnimation->endPoint = Keyframes[minute].duckPoint;
   duckAnimation->startPoint.y = duckAnimation->endPoint.y - FLY_IN_OFFSET_Y;
   // Offset the landing bitmap so feet are in the water
   duckAnimation->endPoint.y += DUCK_LANDING_OFFSET_Y;
         
-  if (isMovingRight(minute)) {
+  if (Keyframes[minute].duckMovingRight) {
     duckAnimation->startPoint.x = OFF_SCREEN_LEFT_COORD;
     duckAnimation->resourceId = RESOURCE_ID_IMAGE_DUCK_LANDING;
 
@@ -426,23 +442,16 @@ static DuckAnimation* getFlyInAnimation(uint16_t minute) {
   duckAnimation->duration = FLY_IN_DURATION;
   duckAnimation->animationCurve = AnimationCurveEaseOut;
   duckAnimation->animationStoppedHandler = flyInAnimationStopped;
-  
-  return duckAnimation;
 }
 
-static DuckAnimation* getFlyOutAnimation(uint16_t minute) {
-  DuckAnimation *duckAnimation = malloc(sizeof(DuckAnimation));
-  if (duckAnimation == NULL) {
-    return NULL;
-  }
-  
+static void getFlyOutAnimation(uint16_t minute, DuckAnimation *duckAnimation) {
   memset(duckAnimation, 0, sizeof(DuckAnimation));
-  duckAnimation->startPoint = getDuckWavePoint(minute);
+  duckAnimation->startPoint = Keyframes[minute].duckPoint;
   duckAnimation->endPoint.y = duckAnimation->startPoint.y - FLY_IN_OFFSET_Y;
   // Offset the take off bitmap so feet are in the water
   duckAnimation->startPoint.y += DUCK_FLY_OUT_OFFSET_Y;
         
-  if (isMovingRight(minute)) {
+  if (Keyframes[minute].duckMovingRight) {
     duckAnimation->endPoint.x = OFF_SCREEN_RIGHT_COORD;
     duckAnimation->resourceId = RESOURCE_ID_IMAGE_DUCK_TAKING_OFF;
 
@@ -454,8 +463,6 @@ static DuckAnimation* getFlyOutAnimation(uint16_t minute) {
   duckAnimation->duration = FLY_OUT_DURATION;
   duckAnimation->animationCurve = AnimationCurveEaseIn;
   duckAnimation->animationStoppedHandler = flyOutAnimationStopped;
-  
-  return duckAnimation;
 }
 
 static DISPLAY_ACTION getDisplayAction(DuckLayerData *data, uint16_t minute, uint16_t second, bool firstDisplay) {
@@ -480,9 +487,10 @@ static DISPLAY_ACTION getDisplayAction(DuckLayerData *data, uint16_t minute, uin
   // At first display or minute zero check for fly-in animation
   if (firstDisplay || minute == 0) {
     
-    // Do the fly-in animation if the scene criteria are met and it's not too late in the
-    // current minute to perform the animation.
-    if ((isSharkSceneControl(data->scene, minute) == false) && (second <= FLY_IN_CUTOFF_SECOND)) {
+    // Do the fly-in animation if the scene criteria are met, it's not too late in the
+    // current minute to perform the animation and the battery isn't low.
+    if ((isSharkSceneControl(data->scene, minute) == false) && (second <= FLY_IN_CUTOFF_SECOND) &&
+        TransitionsAllowed()) {
       return DISPLAY_FLY_IN;
     }
   }
@@ -499,17 +507,17 @@ static uint32_t getDuckResourceId(uint16_t minute, SCENE scene) {
         resourceId = 0;
         
       } else {
-        resourceId = isMovingRight(minute) ? RESOURCE_ID_IMAGE_DUCK : RESOURCE_ID_IMAGE_DUCK_LEFT;
+        resourceId = Keyframes[minute].duckMovingRight ? RESOURCE_ID_IMAGE_DUCK : RESOURCE_ID_IMAGE_DUCK_LEFT;
       }
 
       break;
     
     case THANKSGIVING:
-      resourceId = isMovingRight(minute) ? RESOURCE_ID_IMAGE_TURKEY : RESOURCE_ID_IMAGE_TURKEY_LEFT;
+      resourceId = Keyframes[minute].duckMovingRight ? RESOURCE_ID_IMAGE_TURKEY : RESOURCE_ID_IMAGE_TURKEY_LEFT;
       break;
     
     default:
-      resourceId = isMovingRight(minute) ? RESOURCE_ID_IMAGE_DUCK : RESOURCE_ID_IMAGE_DUCK_LEFT;
+      resourceId = Keyframes[minute].duckMovingRight ? RESOURCE_ID_IMAGE_DUCK : RESOURCE_ID_IMAGE_DUCK_LEFT;
       break;
   }
   
@@ -553,6 +561,11 @@ static bool canDoFlyOut(DuckLayerData *data, uint16_t minute, uint16_t second, i
     return false;
   }
   
+  // On a low battery the duck only flies to get away from the shark.
+  if (TransitionsAllowed() == false) {
+    return false;
+  }
+  
   // Don't fly out if landing time falls in the dive sequence.
   if (landingMilliSecond >= 60000 && minute == (BEGIN_DIVE_MINUTE - 1)) {
     return false;
@@ -573,22 +586,11 @@ static bool isSharkSceneControl(SCENE scene, uint16_t minute) {
 }
 
 static bool isAnimationInProgress() {
-  return (_animation != NULL || _rotationTimer != NULL || _flyInTimer != NULL || _flyOutTimer != NULL);
+  return (_animation != NULL || _flyInPending || _flyOutPending);
 }
 
 static void disableAnimations(DuckAnimation *duckAnimation) {
   duckAnimation->duration = 0;
-  duckAnimation->rotation.increment = 0;
-}
-
-static GPoint getDuckWavePoint(uint16_t minute) {
-  GPoint wavePoint;
-  uint16_t horizontalPosition = getHorizontalPosition(minute);
-  
-  wavePoint.x = _duckCoordinateX[horizontalPosition];
-  wavePoint.y = WATER_TOP(minute) - WAVE_HEIGHT + _waveOffsetY[horizontalPosition];
-    
-  return wavePoint;
 }
 
 static GRect getFrameFromPoint(GPoint bottomCenter, int16_t width, int16_t height) {
@@ -597,7 +599,7 @@ static GRect getFrameFromPoint(GPoint bottomCenter, int16_t width, int16_t heigh
 
 static void resolveCoordinateSubstitution(GPoint *point, uint16_t objectWidth, uint16_t minute) {
   if (minute > 0 && (point->x == PREVIOUS_COORD || point->y == PREVIOUS_COORD)) {
-    GPoint previousPoint = getDuckWavePoint(minute - 1);
+    GPoint previousPoint = Keyframes[minute - 1].duckPoint;
     
     if (point->x == PREVIOUS_COORD) {
       point->x = previousPoint.x;
@@ -616,31 +618,10 @@ static void resolveCoordinateSubstitution(GPoint *point, uint16_t objectWidth, u
   }
 }
 
-static uint16_t getHorizontalPosition(uint16_t minute) {
-  uint16_t position;
-  if (isMovingRight(minute)) {
-    position = minute % HORIZONTAL_POSITIONS;
-    
-  } else {
-    position = HORIZONTAL_POSITIONS - (minute % HORIZONTAL_POSITIONS) - 1;
-  }
-  
-  return position;
-}
-
-static bool isMovingRight(uint16_t minute) {
-  if (minute < HORIZONTAL_POSITIONS || (minute >= (HORIZONTAL_POSITIONS * 2) && minute < (HORIZONTAL_POSITIONS * 3))) {
-    return true;
-  }
-  
-  return false;
-}
-
 static void moveAnimationStopped(Animation *animation, bool finished, void *context) {
-  property_animation_destroy(_animation);
   _animation = NULL;
   
-  if (finished) {
+  if (finished && DecorationsAllowed()) {
     DuckLayerData *data = (DuckLayerData*) context;
     if (data->bubbleData != NULL) {
       addBubbles(data);
@@ -652,83 +633,99 @@ static void moveAnimationStopped(Animation *animation, bool finished, void *cont
 }
 
 static void flyInAnimationStopped(Animation *animation, bool finished, void *context) {
-  property_animation_destroy(_animation);
   _animation = NULL;
   
+  // Start the next animation from the next frame rather than inside this handler.
   if (finished) {
-    _flyInTimer = app_timer_register(10, (AppTimerCallback) flyInFinishedTimerCallback, context);
+    _flyInPending = FrameSchedulerAdd(flyInFinishedFrameCallback, context, FRAME_INTERVAL);
   }
 }
 
 static void flyOutAnimationStopped(Animation *animation, bool finished, void *context) {
-  property_animation_destroy(_animation);
   _animation = NULL;
   
   if (finished) {
-    _flyOutTimer = app_timer_register(10, (AppTimerCallback) flyOutFinishedTimerCallback, context);
+    _flyOutPending = FrameSchedulerAdd(flyOutFinishedFrameCallback, context, FRAME_INTERVAL);
   }
 }
 
-static void flyInFinishedTimerCallback(void *callback_data) {
-  _flyInTimer = NULL;
+static bool flyInFinishedFrameCallback(void *context, uint32_t elapsedMs) {
+  _flyInPending = false;
   
   if (isAnimationInProgress()) {
-    return;
+    return false;
   }
   
-  DuckLayerData *data = (DuckLayerData*) callback_data;
-  DuckAnimation *duckAnimation = getAnimation(data->lastUpdateMinute, data->scene);
-  if (duckAnimation == NULL) {
-    return;
+  DuckLayerData *data = (DuckLayerData*) context;
+  DuckAnimation duckAnimation;
+  if (getAnimation(data->lastUpdateMinute, data->scene, &duckAnimation) == false) {
+    return false;
   }
 
-  disableAnimations(duckAnimation);
-  _animation = runAnimation(data, duckAnimation, data->lastUpdateMinute);
-  free(duckAnimation);
+  disableAnimations(&duckAnimation);
+  _animation = runAnimation(data, &duckAnimation, data->lastUpdateMinute);
+  return false;
 }
 
-static void flyOutFinishedTimerCallback(void *callback_data) {
-  _flyOutTimer = NULL;
+static bool flyOutFinishedFrameCallback(void *context, uint32_t elapsedMs) {
+  _flyOutPending = false;
   
   if (isAnimationInProgress()) {
-    return;
+    return false;
   }
 
-  DuckLayerData *data = (DuckLayerData*) callback_data;
+  DuckLayerData *data = (DuckLayerData*) context;
   
   // Do not fly in if duck has already exited such as escaping the shark.
   if (data->exited) {
-    return;
+    return false;
   }
   
-  DuckAnimation *duckAnimation = getFlyInAnimation(data->flyInReturnMinute);
-  if (duckAnimation == NULL) {
-    return;
-  }
+  DuckAnimation duckAnimation;
+  getFlyInAnimation(data->flyInReturnMinute, &duckAnimation);
+  duckAnimation.delay = data->flyInDelayAnimation;
+  _animation = runAnimation(data, &duckAnimation, data->flyInReturnMinute);
+  return false;
+}
+
+static void moveAnimationUpdate(Animation *animation, const uint32_t distance_normalized) {
+  setMoveProgress((DuckLayerData*) animation_get_context(animation), (int32_t) distance_normalized);
+}
 
-  duckAnimation->delay = data->flyInDelayAnimation;
-  _animation = runAnimation(data, duckAnimation, data->flyInReturnMinute);
-  free(duckAnimation);
+static void moveTransitionUpdate(void *context, uint32_t progress) {
+  setMoveProgress((DuckLayerData*) context, (int32_t) progress);
 }
 
-static void rotationTimerCallback(void *callback_data) {
-  _rotationTimer = NULL;
-  DuckLayerData *data = (DuckLayerData*) callback_data;
+static void setMoveProgress(DuckLayerData *data, int32_t progress) {
+  GRect frame = _move.startFrame;
+  frame.origin.x += (_move.endFrame.origin.x - _move.startFrame.origin.x) * progress / ANIMATION_NORMALIZED_MAX;
+  frame.origin.y += (_move.endFrame.origin.y - _move.startFrame.origin.y) * progress / ANIMATION_NORMALIZED_MAX;
+  layer_set_frame((Layer*) data->duck.layer, frame);
   
-  data->duck.angle += _rotationIncrement;
-  if (data->duck.angle < 0) {
-    data->duck.angle += 360;
-    
-  } else if (data->duck.angle > 360) {
-    data->duck.angle -= 360;    
+  if (_move.rotation == 0) {
+    return;
   }
   
-  rot_bitmap_layer_set_angle(data->duck.layer, PEBBLE_ANGLE_FROM_DEGREE(data->duck.angle));
-  _rotationAmount -= abs(_rotationIncrement);
+  int32_t turned = _move.rotation * progress / ANIMATION_NORMALIZED_MAX;
   
-  if (_rotationAmount > 0) {
-    _rotationTimer = app_timer_register(ROTATION_INCREMENT_DURATION, (AppTimerCallback) rotationTimerCallback, (void*) data);
+  // A turn with its own speed runs linearly from the move's first frame, whatever the
+  // move's curve, and is complete by the time the move is.
+  if (_move.turnMs > 0 && progress < ANIMATION_NORMALIZED_MAX) {
+    uint32_t now = NowMs();
+    if (_move.started == false) {
+      _move.startMs = now;
+      _move.started = true;
+    }
+    
+    uint32_t elapsedMs = now - _move.startMs;
+    turned = (elapsedMs >= _move.turnMs) ? _move.rotation : _move.rotation * (int32_t) elapsedMs / (int32_t) _move.turnMs;
   }
+  
+  setDuckAngle(data, _move.startAngle + turned);
+}
+
+static void setDuckAngle(DuckLayerData *data, int32_t angle) {
+  RotBitmapGroupSetAngle(&data->duck, ((angle % 360) + 360) % 360);
 }
 
 static uint32_t calcDegreeDiff(int32_t startDegree, int32_t endDegree, bool rotateCW) {
@@ -5,6 +5,7 @@
   
 typedef struct {
   RotBitmapGroup duck;
+  Animation *moveAnimation;   // Created with the layer and reused for every move
   SCENE scene;
   bool hidden;
   int16_t lastUpdateMinute;
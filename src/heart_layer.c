@@ -1,21 +1,24 @@
 #include <pebble.h>
 #include "heart_layer.h"
+#include "bitmap_cache.h"
 
-#define HEART_TIMER_INTERVAL 100
-
-static AppTimer *_heartTimer = NULL;
-static uint16_t _heartStartIndex = 0;
-static uint16_t _heartEndIndex = 0;
-
-static void heartTimerCallback(void *callback_data);
+static void heartLayerUpdateProc(Layer *layer, GContext *ctx);
+static bool heartFrameCallback(void *context, uint32_t elapsedMs);
+static void drawHeart(ParticleEngine *engine, uint16_t index, GContext *ctx, void *context);
 
 HeartLayerData* CreateHeartLayer(Layer* relativeLayer, LayerRelation relation) {
   HeartLayerData* data = malloc(sizeof(HeartLayerData));
   if (data != NULL) {
     memset(data, 0, sizeof(HeartLayerData));
-    data->layer = layer_create(GRect(0, 0, SCREEN_WIDTH, SCREEN_HEIGHT));
+    data->layer = layer_create_with_data(GRectZero, sizeof(HeartLayerData*));
+    *(HeartLayerData**) layer_get_data(data->layer) = data;
+    layer_set_update_proc(data->layer, heartLayerUpdateProc);
     AddLayer(relativeLayer, data->layer, relation);
-    data->bitmap = gbitmap_create_with_resource(RESOURCE_ID_IMAGE_HEART);
+    data->bitmap = BitmapCacheAcquire(RESOURCE_ID_IMAGE_HEART);
+    ParticleEngineInit(&data->particles, (ParticleHandlers) {
+      .update = NULL,
+      .draw = drawHeart,
+    }, (data->bitmap != NULL) ? data->bitmap->bounds.size : GSize(0, 0), (void*) data);
   }
   
   return data;
@@ -25,28 +28,8 @@ void DrawHeartLayer(HeartLayerData* data, uint16_t hour, uint16_t minute) {
 }
 
 void DestroyHeartLayer(HeartLayerData* data) {
-  if (_heartTimer != NULL) {
-    app_timer_cancel(_heartTimer);
-    _heartTimer = NULL;
-  }
-  
   if (data != NULL) {
-    for (int heartIndex = 0; heartIndex < MAX_HEARTS; heartIndex++) {
-      if (data->childHearts[heartIndex].animation != NULL) {
-        if (animation_is_scheduled((Animation*) data->childHearts[heartIndex].animation)) {
-          animation_unschedule((Animation*) data->childHearts[heartIndex].animation);
-        }
-        
-        property_animation_destroy(data->childHearts[heartIndex].animation);
-        data->childHearts[heartIndex].animation = NULL;
-      }
-      
-      if (data->childHearts[heartIndex].bitmapLayer != NULL) {
-        layer_remove_from_parent((Layer*) data->childHearts[heartIndex].bitmapLayer);
-        bitmap_layer_destroy(data->childHearts[heartIndex].bitmapLayer);
-        data->childHearts[heartIndex].bitmapLayer = NULL;
-      }
-    }
+    FrameSchedulerRemove(heartFrameCallback, data);
     
     if (data->layer != NULL) {
       layer_destroy(data->layer);
@@ -54,7 +37,7 @@ void DestroyHeartLayer(HeartLayerData* data) {
     }
     
     if (data->bitmap != NULL) {
-      gbitmap_destroy(data->bitmap);
+      BitmapCacheRelease(RESOURCE_ID_IMAGE_HEART);
       data->bitmap = NULL;
     }
     
@@ -62,102 +45,48 @@ void DestroyHeartLayer(HeartLayerData* data) {
   }
 }
 
+// Hearts wait at startOrigin for delayStart milliseconds, then float to endOrigin taking
+// speed milliseconds per pixel.
 void AddHeart(HeartLayerData* data, GPoint startOrigin, GPoint endOrigin, uint16_t speed, uint16_t delayStart) {
-  uint16_t start = _heartStartIndex;
-  uint16_t end = _heartEndIndex;
+  int16_t duration = (startOrigin.y - endOrigin.y) * speed;
+  int32_t velocityX = 0;
+  int32_t velocityY = 0;
+  if (duration > 0) {
+    velocityX = PARTICLE_FIXED(endOrigin.x - startOrigin.x) * 1000 / duration;
+    velocityY = PARTICLE_FIXED(endOrigin.y - startOrigin.y) * 1000 / duration;
+  }
   
-  // Return if full
-  if (isBufferFull(start, end, MAX_HEARTS)) {
+  if (ParticleEngineSpawn(&data->particles, startOrigin, velocityX, velocityY, delayStart, duration, 0) == false) {
     return;
   }
   
-  GRect startFrame = GRect(startOrigin.x - (data->bitmap->bounds.size.w / 2), startOrigin.y - (data->bitmap->bounds.size.h / 2),
-                           data->bitmap->bounds.size.w, data->bitmap->bounds.size.h);
-  
-  GRect stopFrame = GRect(endOrigin.x - (data->bitmap->bounds.size.w / 2), endOrigin.y - (data->bitmap->bounds.size.h / 2),
-                          data->bitmap->bounds.size.w, data->bitmap->bounds.size.h);
+  ParticleEngineFitLayer(&data->particles, data->layer);
+  FrameSchedulerAdd(heartFrameCallback, data, FRAME_INTERVAL);
+}
 
-  data->childHearts[end].bitmapLayer = bitmap_layer_create(startFrame);
-  
-  bitmap_layer_set_compositing_mode(data->childHearts[end].bitmapLayer, GCompOpAnd);
-  bitmap_layer_set_bitmap(data->childHearts[end].bitmapLayer, data->bitmap);
-  AddLayer(data->layer, (Layer*) data->childHearts[end].bitmapLayer, CHILD);
-  
-  // Create the animation and schedule it.
-  data->childHearts[end].animation = property_animation_create_layer_frame((Layer*) data->childHearts[end].bitmapLayer, NULL, &stopFrame);
-  animation_set_duration((Animation*) data->childHearts[end].animation, (startOrigin.y - endOrigin.y) * speed);
-  animation_set_delay((Animation*) data->childHearts[end].animation, delayStart);
-  animation_set_curve((Animation*) data->childHearts[end].animation, AnimationCurveLinear);
-  animation_schedule((Animation*) data->childHearts[end].animation);
-  
-  end++;
-  if (end == MAX_HEARTS) {
-    end = 0;
+static void heartLayerUpdateProc(Layer *layer, GContext *ctx) {
+  HeartLayerData *data = *(HeartLayerData**) layer_get_data(layer);
+  if (data->particles.count == 0 || data->bitmap == NULL) {
+    return;
   }
   
-  _heartEndIndex = end;
-  
-  if (_heartTimer == NULL) {
-    _heartTimer = app_timer_register(HEART_TIMER_INTERVAL, (AppTimerCallback) heartTimerCallback, (void*) data);
-    MY_APP_LOG(APP_LOG_LEVEL_DEBUG, "Heart timer started");
-  }
+  graphics_context_set_compositing_mode(ctx, GCompOpAnd);
+  ParticleEngineDraw(&data->particles, ctx);
 }
 
-static void heartTimerCallback(void *callback_data) {
-  uint16_t start = _heartStartIndex;
-  uint16_t end = _heartEndIndex;
+// Moves the hearts on by the time since the last frame.
+static bool heartFrameCallback(void *context, uint32_t elapsedMs) {
+  HeartLayerData *data = (HeartLayerData*) context;
+  ParticleEngineStep(&data->particles, elapsedMs);
+  ParticleEngineFitLayer(&data->particles, data->layer);
   
-  _heartTimer = NULL;
+  return (data->particles.count > 0);
+}
 
-  // Return if empty
-  if (start == end) {
-    MY_APP_LOG(APP_LOG_LEVEL_DEBUG, "Heart timer stopped");
-    return;
-  }
-  
-  HeartLayerData *data = (HeartLayerData*) callback_data;
-  
-  // Remove any hearts that have completed.
-  uint16_t index = start;
-  while (index != end) {
-    if (data->childHearts[index].bitmapLayer != NULL) {
-      if (data->childHearts[index].animation != NULL &&
-          animation_is_scheduled((Animation*) data->childHearts[index].animation) == false) {
-        
-        property_animation_destroy(data->childHearts[index].animation);
-        data->childHearts[index].animation = NULL;
-        
-        layer_remove_from_parent((Layer*) data->childHearts[index].bitmapLayer);
-        bitmap_layer_destroy(data->childHearts[index].bitmapLayer);
-        data->childHearts[index].bitmapLayer = NULL;
-      }
-    }
-    
-    if (data->childHearts[index].bitmapLayer == NULL &&
-        data->childHearts[index].animation == NULL) {
-    
-      // Heart is complete. Move the start if this heart is at the head.
-      // Otherwise it will have to wait until the heart(s) before it complete.
-      if (index == start) {
-        start = index + 1;
-        if (start == MAX_HEARTS) {
-          start = 0;
-        }
-      }
-    }
-    
-    index++;
-    if (index == MAX_HEARTS) {
-      index = 0;
-    }
-  }
+static void drawHeart(ParticleEngine *engine, uint16_t index, GContext *ctx, void *context) {
+  GBitmap *bitmap = ((HeartLayerData*) context)->bitmap;
+  GSize size = bitmap->bounds.size;
+  GPoint origin = ParticleEngineGetPoint(engine, index);
   
-  _heartStartIndex = start;
-  
-  if (start != end) {
-    _heartTimer = app_timer_register(HEART_TIMER_INTERVAL, (AppTimerCallback) heartTimerCallback, (void*) data);
-    
-  } else {
-    MY_APP_LOG(APP_LOG_LEVEL_DEBUG, "Heart timer stopped");    
-  }
+  graphics_draw_bitmap_in_rect(ctx, bitmap, GRect(origin.x - (size.w / 2), origin.y - (size.h / 2), size.w, size.h));
 }
\ No newline at end of file
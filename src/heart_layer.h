@@ -1,17 +1,11 @@
 #pragma once
 #include "common.h"
-  
-#define MAX_HEARTS 16
-  
-typedef struct {
-  BitmapLayer *bitmapLayer;
-  PropertyAnimation *animation;
-} Heart;
+#include "particle_engine.h"
   
 typedef struct {
   Layer *layer;
   GBitmap *bitmap;
-  Heart childHearts[MAX_HEARTS];
+  ParticleEngine particles;
 } HeartLayerData;
 
 HeartLayerData* CreateHeartLayer(Layer* relativeLayer, LayerRelation relation);
@@ -1,39 +1,33 @@
 #include <pebble.h>
 #include "hour_layer.h"
+#include "bitmap_cache.h"
   
 #define NUMBER_TOP 41
 #define LEFT_HOUR_LEFT 12
 #define MIDDLE_HOUR_LEFT 43
 #define RIGHT_HOUR_LEFT 76
-#define NUMBER_HEIGHT 84
-#define NUMBER_WIDTH 59
+// The digits image is a column of ten numbers, 0 at the top.
+#define NUMBER_HEIGHT (IMAGE_DIGITS_HEIGHT / 10)
+#define NUMBER_WIDTH IMAGE_DIGITS_WIDTH
 
-static uint32_t _hourResource[10] = { 
-  RESOURCE_ID_IMAGE_0, RESOURCE_ID_IMAGE_1, RESOURCE_ID_IMAGE_2, 
-  RESOURCE_ID_IMAGE_3, RESOURCE_ID_IMAGE_4, RESOURCE_ID_IMAGE_5, 
-  RESOURCE_ID_IMAGE_6, RESOURCE_ID_IMAGE_7, RESOURCE_ID_IMAGE_8, 
-  RESOURCE_ID_IMAGE_9 
-};
+// The hour bitmap spans from the left digit to the end of the right digit.
+#define HOUR_WIDTH (RIGHT_HOUR_LEFT + NUMBER_WIDTH - LEFT_HOUR_LEFT)
 
-static void drawHourGroup(BitmapGroup* group, uint16_t digit);
-static uint16_t getHour(uint16_t hour);
+static void composeHour(HourLayerData* data, uint16_t hour, bool clock24Hour);
+static void composeDigit(GBitmap *hourBitmap, GBitmap *digitsBitmap, uint16_t digit, int16_t offsetX);
+static uint16_t getHour(uint16_t hour, bool clock24Hour);
 
 HourLayerData* CreateHourLayer(Layer* relativeLayer, LayerRelation relation) {
   HourLayerData* data = malloc(sizeof(HourLayerData));
   if (data != NULL) {
     memset(data, 0, sizeof(HourLayerData));
+    data->hour = -1;
     
-    data->leftHour.layer = bitmap_layer_create(GRect(LEFT_HOUR_LEFT, NUMBER_TOP, NUMBER_WIDTH, NUMBER_HEIGHT));
-    bitmap_layer_set_compositing_mode(data->leftHour.layer, GCompOpAnd);
-    AddLayer(relativeLayer, (Layer*) data->leftHour.layer, relation);
-    
-    data->middleHour.layer = bitmap_layer_create(GRect(MIDDLE_HOUR_LEFT, NUMBER_TOP, NUMBER_WIDTH, NUMBER_HEIGHT));
-    bitmap_layer_set_compositing_mode(data->middleHour.layer, GCompOpAnd);
-    AddLayer(relativeLayer, (Layer*) data->middleHour.layer, relation);
-    
-    data->rightHour.layer = bitmap_layer_create(GRect(RIGHT_HOUR_LEFT, NUMBER_TOP, NUMBER_WIDTH, NUMBER_HEIGHT));
-    bitmap_layer_set_compositing_mode(data->rightHour.layer, GCompOpAnd);
-    AddLayer(relativeLayer, (Layer*) data->rightHour.layer, relation);
+    data->bitmap = gbitmap_create_blank(GSize(HOUR_WIDTH, NUMBER_HEIGHT));
+    data->layer = bitmap_layer_create(GRect(LEFT_HOUR_LEFT, NUMBER_TOP, HOUR_WIDTH, NUMBER_HEIGHT));
+    bitmap_layer_set_compositing_mode(data->layer, GCompOpAnd);
+    bitmap_layer_set_bitmap(data->layer, data->bitmap);
+    AddLayer(relativeLayer, (Layer*) data->layer, relation);
   }
   
   return data;
@@ -41,73 +35,105 @@ HourLayerData* CreateHourLayer(Layer* relativeLayer, LayerRelation relation) {
 
 void DestroyHourLayer(HourLayerData* data) {
   if (data != NULL) {
-    DestroyBitmapGroup(&data->leftHour);
-    DestroyBitmapGroup(&data->middleHour);
-    DestroyBitmapGroup(&data->rightHour);
+    if (data->layer != NULL) {
+      layer_remove_from_parent((Layer*) data->layer);
+      bitmap_layer_destroy(data->layer);
+      data->layer = NULL;
+    }
+    
+    if (data->bitmap != NULL) {
+      gbitmap_destroy(data->bitmap);
+      data->bitmap = NULL;
+    }
+    
     free(data);
   }
 }
 
-void DrawHourLayer(HourLayerData* data, uint16_t hour, uint16_t minute) {
-  int16_t leftDigit = -1;
-  int16_t middleDigit = -1;
-  int16_t rightDigit = -1;
-  uint16_t trueHour = getHour(hour);
+// Returns true if the digits changed.
+bool DrawHourLayer(HourLayerData* data, uint16_t hour, uint16_t minute) {
+  bool clock24Hour = clock_is_24h_style();
+  uint16_t trueHour = getHour(hour, clock24Hour);
   
-  if (clock_is_24h_style() == true) {
-    leftDigit = trueHour / 10;
-    rightDigit = trueHour % 10;
-    
-  } else {
-    if (trueHour < 10) {
-      middleDigit = trueHour;
-      
-    } else {
-      leftDigit = 1;
-      rightDigit = trueHour % 10;
-    }
+  // Nothing to do until the hour or the clock style changes.
+  if (data->hour == trueHour && data->clock24Hour == clock24Hour) {
+    return false;
   }
   
-  if (leftDigit == -1) {
-    layer_set_hidden((Layer*) data->leftHour.layer, true);
-    
-  } else {
-    drawHourGroup(&data->leftHour, leftDigit);
+  composeHour(data, trueHour, clock24Hour);
+  data->hour = trueHour;
+  data->clock24Hour = clock24Hour;
+  layer_mark_dirty((Layer*) data->layer);
+  return true;
+}
+
+// Draws the hour digits into the hour bitmap and fits the layer to them. The digit atlas
+// is only held from the bitmap cache for the duration of the composition.
+static void composeHour(HourLayerData* data, uint16_t hour, bool clock24Hour) {
+  if (data->bitmap == NULL) {
+    return;
   }
   
-  if (middleDigit == -1) {
-    layer_set_hidden((Layer*) data->middleHour.layer, true);
-    
-  } else {
-    drawHourGroup(&data->middleHour, middleDigit);
+  // Start from white, digits are black on white and combined with And.
+  memset(data->bitmap->addr, 0xFF, data->bitmap->row_size_bytes * NUMBER_HEIGHT);
+  
+  GBitmap *digitsBitmap = BitmapCacheAcquire(RESOURCE_ID_IMAGE_DIGITS);
+  if (digitsBitmap == NULL) {
+    return;
   }
   
-  if (rightDigit == -1) {
-    layer_set_hidden((Layer*) data->rightHour.layer, true);
+  int16_t left = LEFT_HOUR_LEFT;
+  int16_t width = HOUR_WIDTH;
+  
+  if (clock24Hour == true) {
+    composeDigit(data->bitmap, digitsBitmap, hour / 10, LEFT_HOUR_LEFT - left);
+    composeDigit(data->bitmap, digitsBitmap, hour % 10, RIGHT_HOUR_LEFT - left);
+    
+  } else if (hour < 10) {
+    left = MIDDLE_HOUR_LEFT;
+    width = NUMBER_WIDTH;
+    composeDigit(data->bitmap, digitsBitmap, hour, 0);
     
   } else {
-    drawHourGroup(&data->rightHour, rightDigit);
+    composeDigit(data->bitmap, digitsBitmap, 1, LEFT_HOUR_LEFT - left);
+    composeDigit(data->bitmap, digitsBitmap, hour % 10, RIGHT_HOUR_LEFT - left);
   }
+  
+  BitmapCacheRelease(RESOURCE_ID_IMAGE_DIGITS);
+  
+  // Only the columns in use are drawn, so a single digit costs no more than before.
+  data->bitmap->bounds = GRect(0, 0, width, NUMBER_HEIGHT);
+  layer_set_frame((Layer*) data->layer, GRect(left, NUMBER_TOP, width, NUMBER_HEIGHT));
+  layer_set_bounds((Layer*) data->layer, GRect(0, 0, width, NUMBER_HEIGHT));
 }
 
-static void drawHourGroup(BitmapGroup* group, uint16_t digit) {
-  if (group->resourceId != _hourResource[digit]) {
-    if (group->bitmap != NULL) {
-      gbitmap_destroy(group->bitmap);
-      group->bitmap = NULL;
-      group->resourceId = 0;
-    }
+// Ands one digit of the atlas into the hour bitmap at column offsetX.
+static void composeDigit(GBitmap *hourBitmap, GBitmap *digitsBitmap, uint16_t digit, int16_t offsetX) {
+  GBitmap *digitBitmap = gbitmap_create_as_sub_bitmap(digitsBitmap, GRect(0, digit * NUMBER_HEIGHT, NUMBER_WIDTH, NUMBER_HEIGHT));
+  if (digitBitmap == NULL) {
+    return;
+  }
+  
+  GRect source = digitBitmap->bounds;
+  
+  for (int16_t y = 0; y < NUMBER_HEIGHT; y++) {
+    const uint8_t *sourceRow = (const uint8_t*) digitBitmap->addr + (source.origin.y + y) * digitBitmap->row_size_bytes;
+    uint8_t *targetRow = (uint8_t*) hourBitmap->addr + y * hourBitmap->row_size_bytes;
     
-    group->bitmap = gbitmap_create_with_resource(_hourResource[digit]);
-    bitmap_layer_set_bitmap(group->layer, group->bitmap);
-    group->resourceId = _hourResource[digit];
-  }  
+    for (int16_t x = 0; x < NUMBER_WIDTH; x++) {
+      int16_t sourceX = source.origin.x + x;
+      if ((sourceRow[sourceX / 8] & (1 << (sourceX % 8))) == 0) {
+        int16_t targetX = offsetX + x;
+        targetRow[targetX / 8] &= ~(1 << (targetX % 8));
+      }
+    }
+  }
   
-  layer_set_hidden(bitmap_layer_get_layer(group->layer), false);
+  gbitmap_destroy(digitBitmap);
 }
 
-static uint16_t getHour(uint16_t hour) {
-  if (clock_is_24h_style() == true) {
+static uint16_t getHour(uint16_t hour, bool clock24Hour) {
+  if (clock24Hour == true) {
     return hour;
   }
   
@@ -2,11 +2,12 @@
 #include "common.h"
 
 typedef struct {
-  BitmapGroup leftHour;
-  BitmapGroup middleHour;
-  BitmapGroup rightHour;
+  BitmapLayer *layer;
+  GBitmap *bitmap;        // Hour digits composed once per hour change
+  int16_t hour;
+  bool clock24Hour;
 } HourLayerData;
 
 HourLayerData* CreateHourLayer(Layer* relativeLayer, LayerRelation relation);
-void DrawHourLayer(HourLayerData* data, uint16_t hour, uint16_t minute);
+bool DrawHourLayer(HourLayerData* data, uint16_t hour, uint16_t minute);
 void DestroyHourLayer(HourLayerData* data);
\ No newline at end of file
@@ -1,14 +1,16 @@
 #include <pebble.h>
 #include "common.h"
+#include "background_layer.h"
 #include "marker_layer.h"
 #include "hour_layer.h"
 #include "water_layer.h"
-#include "waves_layer.h"
 #include "duck_layer.h"
 #include "shark_layer.h"
 #include "santa_layer.h"
 #include "message_layer.h"
 #include "status_layer.h"
+#include "bitmap_cache.h"
+#include "rotation_cache.h"
   
 #ifdef RUN_TEST
 #include "test_unit.h"
@@ -26,12 +28,29 @@
 #define KEY_SHARK_VIBRATE_START 9
 #define KEY_SHARK_VIBRATE_END 10
 #define KEY_REQUEST_SETUP_INFO 11
+#define KEY_PROFILE_SUMMARY 12
+#define KEY_BATTERY_SAVER 13
+
+// Persist key of the whole Settings struct. It is never sent over AppMessage.
+#define KEY_SETTINGS 14
+#define KEY_SETTINGS_PACKED 15
+
+// Bump when Settings changes, and migrate the older layout in loadSettings().
+#define SETTINGS_VERSION 1
   
 #define MESSAGE_SETTINGS_DURATION 1500
 #define MESSAGE_BLUETOOTH_DURATION 5000
 
 #define VIBES_SHORT_IGNORE_TAPS_TIME 2000
 
+// Battery charge at or below which the battery saver moves to each PowerTier.
+#define POWER_SAVING_PERCENT 30
+#define POWER_LOW_PERCENT 10
+
+#ifdef PROFILING_ON
+#define PROFILE_SUMMARY_SIZE 400
+#endif
+
 typedef struct {
   int32_t currentVersion;
   int32_t hourVibrate;
@@ -42,13 +61,38 @@ typedef struct {
   int32_t sharkVibrate;
   int32_t sharkVibrateStart;
   int32_t sharkVibrateEnd;
+  int32_t batterySaver;
 } Settings;
 
+typedef struct {
+  int32_t version;
+  Settings settings;
+} StoredSettings;
+
+// Byte offsets in the KEY_SETTINGS_PACKED byte array sent by pebble-js-app.js. Every
+// setting fits in a byte. Later formats may append settings but not move these.
+typedef enum {
+  PACKED_FORMAT,
+  PACKED_CURRENT_VERSION,
+  PACKED_HOUR_VIBRATE,
+  PACKED_HOUR_VIBRATE_START,
+  PACKED_HOUR_VIBRATE_END,
+  PACKED_BLUETOOTH_VIBRATE,
+  PACKED_SCENE_OVERRIDE,
+  PACKED_SHARK_VIBRATE,
+  PACKED_SHARK_VIBRATE_START,
+  PACKED_SHARK_VIBRATE_END,
+  PACKED_BATTERY_SAVER,
+  PACKED_SETTINGS_SIZE
+} PackedSetting;
+
+#define PACKED_SETTINGS_FORMAT 1
+
 static Window* _mainWindow = NULL;
+static BackgroundLayerData* _backgroundData = NULL;
 static MarkerLayerData* _markerData = NULL;
 static HourLayerData* _hourData = NULL;
 static WaterLayerData* _waterData = NULL;
-static WavesLayerData* _wavesData = NULL;
 static DuckLayerData* _duckData = NULL;
 static SharkLayerData* _sharkData = NULL;
 static SantaLayerData* _santaData = NULL;
@@ -59,8 +103,14 @@ static StatusLayerData *_statusData = NULL;
 static TestUnitData* _testUnitData = NULL;
 #endif
 
+#ifdef PROFILING_ON
+static char _profileSummary[PROFILE_SUMMARY_SIZE];
+#endif
+
 static SCENE _scene;
 static Settings _settings;
+static Settings _savedSettings;   // As last read from or written to persistent storage
+static bool _settingsStored = false;
 static AppTimer *_messageTimer = NULL;
 static AppTimer *_sharkWarnTimer = NULL;
 static AppTimer *_ignoreTapTimer = NULL;
@@ -83,9 +133,16 @@ static void outbox_sent_callback(DictionaryIterator *values, void *context);
 static void outbox_failed_callback(DictionaryIterator *failed, AppMessageResult reason, void *context);
 static void loadSettings(Settings *settings);
 static void saveSettings(Settings *settings);
+static void setDefaultSettings(Settings *settings);
+static void loadLegacySettings(Settings *settings);
+static void deleteLegacySettings();
+static bool unpackSettings(Settings *settings, const Tuple *tuple);
 static int32_t readPersistentInt(const uint32_t key, int32_t defaultValue);
 static bool isHourInRange(int16_t hour, int16_t start, int16_t end);
 static void sendSetupInfo();
+#ifdef PROFILING_ON
+static void sendProfileSummary();
+#endif
 static void showMessage(const char *text, uint32_t duration);
 static void messageTimerCallback(void *callback_data);
 static void sharkWarnTimerCallback(void *callback_data);
@@ -97,6 +154,7 @@ static SCENE getScene(struct tm *tick_time);
 static void switchScene(SCENE scene);
 static struct tm* getTime(struct tm *real_time);
 static void vibrate();
+static void updatePowerTier(BatteryChargeState charge_state);
 
 int main(void) {
   init();
@@ -146,8 +204,15 @@ static void init() {
   app_message_register_outbox_sent(outbox_sent_callback);
   app_message_register_outbox_failed(outbox_failed_callback);
   
-  // Open AppMessage
-  app_message_open(app_message_inbox_size_maximum(), app_message_outbox_size_maximum());
+  // Open AppMessage with buffers sized for the largest message each way: the packed
+  // settings in, and the setup info (or profile summary) out.
+  uint32_t inboxSize = dict_calc_buffer_size(1, (uint32_t) PACKED_SETTINGS_SIZE);
+#ifdef PROFILING_ON
+  uint32_t outboxSize = dict_calc_buffer_size(1, (uint32_t) PROFILE_SUMMARY_SIZE);
+#else
+  uint32_t outboxSize = dict_calc_buffer_size(2, (uint32_t) sizeof(int32_t), (uint32_t) sizeof(int32_t));
+#endif
+  app_message_open(inboxSize, outboxSize);
 }
 
 static void deinit() {
@@ -183,17 +248,22 @@ static void deinit() {
     window_destroy(_mainWindow);
     _mainWindow = NULL;
   }
+  
+  DestroyMinuteTransition();
+  DestroyFrameScheduler();
+  DestroyRotationCache();
+  DestroyBitmapCache();
 }
 
 static void main_window_load(Window *window) {
   window_set_background_color(window, GColorWhite);
   
-  // Fixed layers
-  _markerData = CreateMarkerLayer(window_get_root_layer(_mainWindow), CHILD);
-  _statusData = CreateStatusLayer(window_get_root_layer(_mainWindow), CHILD);
-  _hourData = CreateHourLayer(window_get_root_layer(_mainWindow), CHILD);
-  _waterData = CreateWaterLayer(window_get_root_layer(_mainWindow), CHILD);
-  _wavesData = CreateWavesLayer(window_get_root_layer(_mainWindow), CHILD);
+  // Fixed layers, the ones that only change with the minute drawn into the background.
+  PROFILE_HEAP("background", _backgroundData = CreateBackgroundLayer(window_get_root_layer(_mainWindow), CHILD));
+  PROFILE_HEAP("marker", _markerData = CreateMarkerLayer(_backgroundData->contentLayer, CHILD));
+  PROFILE_HEAP("status", _statusData = CreateStatusLayer(_backgroundData->contentLayer, CHILD));
+  PROFILE_HEAP("hour", _hourData = CreateHourLayer(_backgroundData->contentLayer, CHILD));
+  PROFILE_HEAP("water", _waterData = CreateWaterLayer(window_get_root_layer(_mainWindow), CHILD));
   
   // Initialize Bluetooth status
   bool connected = bluetooth_connection_service_peek();
@@ -204,48 +274,56 @@ static void main_window_load(Window *window) {
   BatteryChargeState batteryState = battery_state_service_peek();
   ShowBatteryStatus(_statusData, (batteryState.is_charging || batteryState.is_plugged));
   UpdateBatteryStatus(_statusData, batteryState);
+  updatePowerTier(batteryState);
   
   updateApp(getTime(NULL));
 }
 
 static void main_window_unload(Window *window) {
   if (_messageData != NULL) {
-    DestroyMessageLayer(_messageData);
+    PROFILE_HEAP("message", DestroyMessageLayer(_messageData));
     _messageData = NULL;
   }
   
   if (_santaData != NULL) {
-    DestroySantaLayer(_santaData);    
+    PROFILE_HEAP("santa", DestroySantaLayer(_santaData));
     _santaData = NULL;
   }
 
   if (_sharkData != NULL) {
-    DestroySharkLayer(_sharkData);    
+    PROFILE_HEAP("shark", DestroySharkLayer(_sharkData));
     _sharkData = NULL;
   }
   
   if (_duckData != NULL) {
-    DestroyDuckLayer(_duckData);
+    PROFILE_HEAP("duck", DestroyDuckLayer(_duckData));
     _duckData = NULL;
   }
   
-  DestroyWavesLayer(_wavesData);
-  _wavesData = NULL;
-  
-  DestroyWaterLayer(_waterData);
+  PROFILE_HEAP("water", DestroyWaterLayer(_waterData));
   _waterData = NULL;
   
-  DestroyHourLayer(_hourData);
+  PROFILE_HEAP("hour", DestroyHourLayer(_hourData));
   _hourData = NULL;
   
-  DestroyStatusLayer(_statusData);
+  PROFILE_HEAP("status", DestroyStatusLayer(_statusData));
   _statusData = NULL;
   
-  DestroyMarkerLayer(_markerData);
+  PROFILE_HEAP("marker", DestroyMarkerLayer(_markerData));
   _markerData = NULL;
+  
+  PROFILE_HEAP("background", DestroyBackgroundLayer(_backgroundData));
+  _backgroundData = NULL;
 }
 
 static void timer_handler(struct tm *tick_time, TimeUnits units_changed) {
+#ifdef PROFILING_ON
+  // Report the minute that just ended before this minute's drawing starts.
+  if ((units_changed & MINUTE_UNIT) != 0) {
+    sendProfileSummary();
+  }
+#endif
+
   struct tm *localNow = getTime(tick_time);
   updateApp(localNow);
   
@@ -294,62 +372,14 @@ static void inbox_received_callback(DictionaryIterator *iterator, void *context)
     return;
   }
 
-  while (tuple != NULL) {
-    switch (tuple->key) {
-      case KEY_CURRENT_VERSION:
-        _settings.currentVersion = tuple->value->int32;
-        MY_APP_LOG(APP_LOG_LEVEL_INFO, "Current version %i", (int) _settings.currentVersion);
-        break;
-      
-      case KEY_HOUR_VIBRATE:
-        _settings.hourVibrate = tuple->value->int32;
-        MY_APP_LOG(APP_LOG_LEVEL_INFO, "Hourly vibrate %i", (int) _settings.hourVibrate);
-        break;
-      
-      case KEY_HOUR_VIBRATE_START:
-        _settings.hourVibrateStart = tuple->value->int32;
-        MY_APP_LOG(APP_LOG_LEVEL_INFO, "Hourly vibrate start %i", (int) _settings.hourVibrateStart);
-        break;
-      
-      case KEY_HOUR_VIBRATE_END:
-        _settings.hourVibrateEnd = tuple->value->int32;
-        MY_APP_LOG(APP_LOG_LEVEL_INFO, "Hourly vibrate end %i", (int) _settings.hourVibrateEnd);
-        break;
-      
-      case KEY_BLUETOOTH_VIBRATE:
-        _settings.bluetoothVibrate = tuple->value->int32;
-        MY_APP_LOG(APP_LOG_LEVEL_INFO, "Bluetooth vibrate %i", (int) _settings.bluetoothVibrate);
-        break;
-      
-      case KEY_SCENE_OVERRIDE:
-        _settings.sceneOverride = tuple->value->int32;
-        MY_APP_LOG(APP_LOG_LEVEL_INFO, "Scene override %i", (int) _settings.sceneOverride);
-        break;
-      
-      case KEY_SHARK_VIBRATE:
-        _settings.sharkVibrate = tuple->value->int32;
-        MY_APP_LOG(APP_LOG_LEVEL_INFO, "Shark vibrate %i", (int) _settings.sharkVibrate);
-        break;
-      
-      case KEY_SHARK_VIBRATE_START:
-        _settings.sharkVibrateStart = tuple->value->int32;
-        MY_APP_LOG(APP_LOG_LEVEL_INFO, "Shark vibrate start %i", (int) _settings.sharkVibrateStart);
-        break;
-      
-      case KEY_SHARK_VIBRATE_END:
-        _settings.sharkVibrateEnd = tuple->value->int32;
-        MY_APP_LOG(APP_LOG_LEVEL_INFO, "Shark vibrate end %i", (int) _settings.sharkVibrateEnd);
-        break;
-      
-      default:
-        MY_APP_LOG(APP_LOG_LEVEL_ERROR, "Key %i not recognized", (int) tuple->key);
-        break;
-    }
-
-    tuple = dict_read_next(iterator);
+  tuple = dict_find(iterator, KEY_SETTINGS_PACKED);
+  if (tuple == NULL || unpackSettings(&_settings, tuple) == false) {
+    MY_APP_LOG(APP_LOG_LEVEL_ERROR, "Settings message not recognized");
+    return;
   }
   
   saveSettings(&_settings);
+  updatePowerTier(battery_state_service_peek());
   showMessage(_settingsReceivedMsg, MESSAGE_SETTINGS_DURATION);    
   updateApp(getTime(NULL));
 }
@@ -372,6 +402,10 @@ static void outbox_sent_callback(DictionaryIterator *values, void *context) {
         MY_APP_LOG(APP_LOG_LEVEL_INFO, "Successfully sent installed version %i to phone", (int) tuple->value->int32);
         break;
       
+      case KEY_PROFILE_SUMMARY:
+        MY_APP_LOG(APP_LOG_LEVEL_INFO, "Successfully sent profile summary to phone");
+        break;
+      
       default:
         MY_APP_LOG(APP_LOG_LEVEL_ERROR, "Key %i not recognized", (int) tuple->key);
         break;
@@ -395,23 +429,35 @@ static void bluetooth_service_handler(bool connected) {
   
   ShowBluetoothStatus(_statusData, !connected);
   UpdateBluetoothStatus(_statusData, connected);
+  InvalidateBackgroundLayer(_backgroundData);
 }
 
 static void battery_service_handler(BatteryChargeState charge_state) {
   ShowBatteryStatus(_statusData, (charge_state.is_charging || charge_state.is_plugged));
   UpdateBatteryStatus(_statusData, charge_state);
+  InvalidateBackgroundLayer(_backgroundData);
+  updatePowerTier(charge_state);
 }
 
 static void loadSettings(Settings *settings) {
-  settings->currentVersion = readPersistentInt(KEY_CURRENT_VERSION, 0);
-  settings->hourVibrate = readPersistentInt(KEY_HOUR_VIBRATE, 0);
-  settings->hourVibrateStart = readPersistentInt(KEY_HOUR_VIBRATE_START, 9);
-  settings->hourVibrateEnd = readPersistentInt(KEY_HOUR_VIBRATE_END, 18);
-  settings->bluetoothVibrate = readPersistentInt(KEY_BLUETOOTH_VIBRATE, 1);
-  settings->sceneOverride = readPersistentInt(KEY_SCENE_OVERRIDE, UNDEFINED_SCENE);
-  settings->sharkVibrate = readPersistentInt(KEY_SHARK_VIBRATE, 1);
-  settings->sharkVibrateStart = readPersistentInt(KEY_SHARK_VIBRATE_START, 9);
-  settings->sharkVibrateEnd = readPersistentInt(KEY_SHARK_VIBRATE_END, 18);
+  StoredSettings stored;
+  if (persist_read_data(KEY_SETTINGS, &stored, sizeof(StoredSettings)) == sizeof(StoredSettings) &&
+      stored.version == SETTINGS_VERSION) {
+    *settings = stored.settings;
+    _savedSettings = stored.settings;
+    _settingsStored = true;
+    
+  } else if (persist_exists(KEY_CURRENT_VERSION)) {
+    // Settings saved before SETTINGS_VERSION 1 have a key each. Move them into the blob.
+    loadLegacySettings(settings);
+    saveSettings(settings);
+    if (_settingsStored) {
+      deleteLegacySettings();
+    }
+    
+  } else {
+    setDefaultSettings(settings);
+  }
   
   MY_APP_LOG(APP_LOG_LEVEL_INFO, "Load settings: currentVersion=%i", (int) settings->currentVersion);
   MY_APP_LOG(APP_LOG_LEVEL_INFO, "Load settings: hourVibrate=%i, Start=%i, End=%i",
@@ -422,6 +468,48 @@ static void loadSettings(Settings *settings) {
   
   MY_APP_LOG(APP_LOG_LEVEL_INFO, "Load settings: sharkVibrate=%i, Start=%i, End=%i",
              (int) settings->sharkVibrate, (int) settings->sharkVibrateStart, (int) settings->sharkVibrateEnd);
+  
+  MY_APP_LOG(APP_LOG_LEVEL_INFO, "Load settings: batterySaver=%i", (int) settings->batterySaver);
+}
+
+static void setDefaultSettings(Settings *settings) {
+  settings->currentVersion = 0;
+  settings->hourVibrate = 0;
+  settings->hourVibrateStart = 9;
+  settings->hourVibrateEnd = 18;
+  settings->bluetoothVibrate = 1;
+  settings->sceneOverride = UNDEFINED_SCENE;
+  settings->sharkVibrate = 1;
+  settings->sharkVibrateStart = 9;
+  settings->sharkVibrateEnd = 18;
+  settings->batterySaver = 1;
+}
+
+static void loadLegacySettings(Settings *settings) {
+  setDefaultSettings(settings);
+  settings->currentVersion = readPersistentInt(KEY_CURRENT_VERSION, settings->currentVersion);
+  settings->hourVibrate = readPersistentInt(KEY_HOUR_VIBRATE, settings->hourVibrate);
+  settings->hourVibrateStart = readPersistentInt(KEY_HOUR_VIBRATE_START, settings->hourVibrateStart);
+  settings->hourVibrateEnd = readPersistentInt(KEY_HOUR_VIBRATE_END, settings->hourVibrateEnd);
+  settings->bluetoothVibrate = readPersistentInt(KEY_BLUETOOTH_VIBRATE, settings->bluetoothVibrate);
+  settings->sceneOverride = readPersistentInt(KEY_SCENE_OVERRIDE, settings->sceneOverride);
+  settings->sharkVibrate = readPersistentInt(KEY_SHARK_VIBRATE, settings->sharkVibrate);
+  settings->sharkVibrateStart = readPersistentInt(KEY_SHARK_VIBRATE_START, settings->sharkVibrateStart);
+  settings->sharkVibrateEnd = readPersistentInt(KEY_SHARK_VIBRATE_END, settings->sharkVibrateEnd);
+  settings->batterySaver = readPersistentInt(KEY_BATTERY_SAVER, settings->batterySaver);
+}
+
+static void deleteLegacySettings() {
+  persist_delete(KEY_CURRENT_VERSION);
+  persist_delete(KEY_HOUR_VIBRATE);
+  persist_delete(KEY_HOUR_VIBRATE_START);
+  persist_delete(KEY_HOUR_VIBRATE_END);
+  persist_delete(KEY_BLUETOOTH_VIBRATE);
+  persist_delete(KEY_SCENE_OVERRIDE);
+  persist_delete(KEY_SHARK_VIBRATE);
+  persist_delete(KEY_SHARK_VIBRATE_START);
+  persist_delete(KEY_SHARK_VIBRATE_END);
+  persist_delete(KEY_BATTERY_SAVER);
 }
 
 static int32_t readPersistentInt(const uint32_t key, int32_t defaultValue) {
@@ -446,16 +534,47 @@ static bool isHourInRange(int16_t hour, int16_t start, int16_t end) {
   return false;
 }
 
+// Reads the KEY_SETTINGS_PACKED byte array into settings. Returns false, leaving settings
+// alone, if the payload is not one this version understands.
+static bool unpackSettings(Settings *settings, const Tuple *tuple) {
+  const uint8_t *packed = tuple->value->data;
+  if (tuple->type != TUPLE_BYTE_ARRAY || tuple->length < PACKED_SETTINGS_SIZE ||
+      packed[PACKED_FORMAT] != PACKED_SETTINGS_FORMAT) {
+    return false;
+  }
+  
+  settings->currentVersion = packed[PACKED_CURRENT_VERSION];
+  settings->hourVibrate = packed[PACKED_HOUR_VIBRATE];
+  settings->hourVibrateStart = packed[PACKED_HOUR_VIBRATE_START];
+  settings->hourVibrateEnd = packed[PACKED_HOUR_VIBRATE_END];
+  settings->bluetoothVibrate = packed[PACKED_BLUETOOTH_VIBRATE];
+  settings->sceneOverride = packed[PACKED_SCENE_OVERRIDE];
+  settings->sharkVibrate = packed[PACKED_SHARK_VIBRATE];
+  settings->sharkVibrateStart = packed[PACKED_SHARK_VIBRATE_START];
+  settings->sharkVibrateEnd = packed[PACKED_SHARK_VIBRATE_END];
+  settings->batterySaver = packed[PACKED_BATTERY_SAVER];
+  
+  MY_APP_LOG(APP_LOG_LEVEL_INFO, "Settings received: version=%i, hourVibrate=%i, Start=%i, End=%i",
+             (int) settings->currentVersion, (int) settings->hourVibrate,
+             (int) settings->hourVibrateStart, (int) settings->hourVibrateEnd);
+  MY_APP_LOG(APP_LOG_LEVEL_INFO, "Settings received: bluetoothVibrate=%i, sceneOverride=%i, batterySaver=%i",
+             (int) settings->bluetoothVibrate, (int) settings->sceneOverride, (int) settings->batterySaver);
+  MY_APP_LOG(APP_LOG_LEVEL_INFO, "Settings received: sharkVibrate=%i, Start=%i, End=%i",
+             (int) settings->sharkVibrate, (int) settings->sharkVibrateStart, (int) settings->sharkVibrateEnd);
+  return true;
+}
+
+// Writes the settings as one blob, and only when they differ from what is stored.
 static void saveSettings(Settings *settings) {
-  persist_write_int(KEY_CURRENT_VERSION, settings->currentVersion);
-  persist_write_int(KEY_HOUR_VIBRATE, settings->hourVibrate);
-  persist_write_int(KEY_HOUR_VIBRATE_START, settings->hourVibrateStart);
-  persist_write_int(KEY_HOUR_VIBRATE_END, settings->hourVibrateEnd);
-  persist_write_int(KEY_BLUETOOTH_VIBRATE, settings->bluetoothVibrate);
-  persist_write_int(KEY_SCENE_OVERRIDE, settings->sceneOverride);
-  persist_write_int(KEY_SHARK_VIBRATE, settings->sharkVibrate);
-  persist_write_int(KEY_SHARK_VIBRATE_START, settings->sharkVibrateStart);
-  persist_write_int(KEY_SHARK_VIBRATE_END, settings->sharkVibrateEnd);
+  if (_settingsStored && memcmp(settings, &_savedSettings, sizeof(Settings)) == 0) {
+    return;
+  }
+  
+  StoredSettings stored = { .version = SETTINGS_VERSION, .settings = *settings };
+  if (persist_write_data(KEY_SETTINGS, &stored, sizeof(StoredSettings)) == sizeof(StoredSettings)) {
+    _savedSettings = *settings;
+    _settingsStored = true;
+  }
 }
 
 static void sendSetupInfo() {
@@ -474,6 +593,26 @@ static void sendSetupInfo() {
   app_message_outbox_send();
 }
 
+#ifdef PROFILING_ON
+static void sendProfileSummary() {
+  if (ProfileSummary(_profileSummary, sizeof(_profileSummary)) == 0) {
+    return;
+  }
+  
+  DictionaryIterator *iter;
+  app_message_outbox_begin(&iter);
+
+  if (iter == NULL) {
+    return;
+  }
+  
+  Tuplet summary = TupletCString(KEY_PROFILE_SUMMARY, _profileSummary);
+  dict_write_tuplet(iter, &summary);
+  dict_write_end(iter);
+  app_message_outbox_send();
+}
+#endif
+
 static void sharkWarnTimerCallback(void *callback_data) {
   _sharkWarnTimer = NULL;
   vibrate();
@@ -497,7 +636,7 @@ static void setSharkWarnTimer(SCENE scene, struct tm *tick_time) {
 static void messageTimerCallback(void *callback_data) {
   _messageTimer = NULL;
   if (_messageData != NULL) {
-    DestroyMessageLayer(_messageData);
+    PROFILE_HEAP("message", DestroyMessageLayer(_messageData));
     _messageData = NULL;
   }
 }
@@ -518,7 +657,7 @@ static void showMessage(const char *text, uint32_t duration) {
   }
   
   if (_messageData == NULL) {
-    _messageData = CreateMessageLayer(window_get_root_layer(_mainWindow), CHILD);
+    PROFILE_HEAP("message", _messageData = CreateMessageLayer(window_get_root_layer(_mainWindow), CHILD));
   }
   
   DrawMessageLayer(_messageData, text);
@@ -549,6 +688,23 @@ static void vibrate() {
   vibes_short_pulse(); 
 }
 
+// Picks how much animation the battery can afford. Animations already running finish;
+// the tier applies to the ones started after it.
+static void updatePowerTier(BatteryChargeState charge_state) {
+  PowerTier tier = POWER_FULL;
+  if (_settings.batterySaver == 1 && charge_state.is_charging == false && charge_state.is_plugged == false) {
+    if (charge_state.charge_percent <= POWER_LOW_PERCENT) {
+      tier = POWER_LOW;
+      
+    } else if (charge_state.charge_percent <= POWER_SAVING_PERCENT) {
+      tier = POWER_SAVING;
+    }
+  }
+  
+  MY_APP_LOG(APP_LOG_LEVEL_INFO, "Power tier %i at %i%%", (int) tier, (int) charge_state.charge_percent);
+  SetPowerTier(tier);
+}
+
 static void updateApp(struct tm *tick_time) {
   drawWatchFace(tick_time);
   
@@ -569,9 +725,11 @@ static void drawWatchFace(struct tm *tick_time) {
   
   DrawMarkerLayer(_markerData, hour, minute);
   DrawStatusLayer(_statusData, hour, minute);
-  DrawHourLayer(_hourData, hour, minute);
+  if (DrawHourLayer(_hourData, hour, minute)) {
+    InvalidateBackgroundLayer(_backgroundData);
+  }
+  
   DrawWaterLayer(_waterData, hour, minute);
-  DrawWavesLayer(_wavesData, hour, minute);
   
   drawScene(scene, hour, minute, second);
 }
@@ -620,33 +778,36 @@ static void switchScene(SCENE scene) {
   
   if (duckLayer == true) {
     if (_duckData == NULL) {
-      _duckData = CreateDuckLayer((Layer*) _waterData->inverterLayer, BELOW_SIBLING, scene);
+      PROFILE_HEAP("duck", _duckData = CreateDuckLayer(_waterData->layer, BELOW_SIBLING, scene));
       
     } else {
-      SwitchSceneDuckLayer(_duckData, scene);
+      PROFILE_HEAP("duck", SwitchSceneDuckLayer(_duckData, scene));
     }
   } else if (duckLayer == false && _duckData != NULL) {
-    DestroyDuckLayer(_duckData);
+    PROFILE_HEAP("duck", DestroyDuckLayer(_duckData));
     _duckData = NULL;
   }
   
   if (sharkLayer == true && _sharkData == NULL) {
-    _sharkData = CreateSharkLayer((Layer*) _waterData->inverterLayer, BELOW_SIBLING, _duckData);
+    PROFILE_HEAP("shark", _sharkData = CreateSharkLayer(_waterData->layer, BELOW_SIBLING, _duckData));
     
   } else if (sharkLayer == false && _sharkData != NULL) {
-    DestroySharkLayer(_sharkData);
+    PROFILE_HEAP("shark", DestroySharkLayer(_sharkData));
     _sharkData = NULL;
   }
   
   if (santaLayer == true && _santaData == NULL) {
-    _santaData = CreateSantaLayer((Layer*) _waterData->inverterLayer, BELOW_SIBLING);
+    PROFILE_HEAP("santa", _santaData = CreateSantaLayer(_waterData->layer, BELOW_SIBLING));
     
   } else if (santaLayer == false && _santaData != NULL) {
-    DestroySantaLayer(_santaData);
+    PROFILE_HEAP("santa", DestroySantaLayer(_santaData));
     _santaData = NULL;
   }
   
   _scene = scene;
+#ifdef PROFILING_ON
+  ProfileHeapScene(scene);
+#endif
 }
 
 static SCENE getScene(struct tm *tick_time) {
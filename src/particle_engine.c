@@ -0,0 +1,145 @@
+#include <pebble.h>
+#include "particle_engine.h"
+
+static void removeParticle(ParticleEngine *engine, uint16_t index);
+static GRect getParticleRect(ParticleEngine *engine, uint16_t index);
+
+void ParticleEngineInit(ParticleEngine *engine, ParticleHandlers handlers, GSize extent, void *context) {
+  memset(engine, 0, sizeof(ParticleEngine));
+  engine->handlers = handlers;
+  engine->extent = extent;
+  engine->context = context;
+}
+
+// Returns false if the engine is full.
+bool ParticleEngineSpawn(ParticleEngine *engine, GPoint origin, int32_t velocityX, int32_t velocityY,
+                         int16_t delayMs, int16_t lifeMs, uint8_t size) {
+  if (engine->count == MAX_PARTICLES) {
+    return false;
+  }
+  
+  uint16_t index = engine->count++;
+  engine->x[index] = PARTICLE_FIXED(origin.x);
+  engine->y[index] = PARTICLE_FIXED(origin.y);
+  engine->velocityX[index] = velocityX;
+  engine->velocityY[index] = velocityY;
+  engine->delayMs[index] = delayMs;
+  engine->lifeMs[index] = lifeMs;
+  engine->size[index] = size;
+  engine->changed = true;
+  
+  return true;
+}
+
+// Moves every particle on by elapsedMs and removes those that have finished.
+void ParticleEngineStep(ParticleEngine *engine, uint32_t elapsedMs) {
+  uint16_t index = 0;
+  
+  while (index < engine->count) {
+    int32_t movingMs = elapsedMs;
+    if (engine->delayMs[index] > 0) {
+      movingMs -= engine->delayMs[index];
+      engine->delayMs[index] = (movingMs < 0) ? -movingMs : 0;
+    }
+    
+    if (movingMs <= 0) {
+      index++;
+      continue;
+    }
+    
+    GPoint oldPoint = ParticleEngineGetPoint(engine, index);
+    engine->x[index] += engine->velocityX[index] * movingMs / 1000;
+    engine->y[index] += engine->velocityY[index] * movingMs / 1000;
+    
+    bool alive = true;
+    if (engine->lifeMs[index] != PARTICLE_LIFE_UNLIMITED) {
+      alive = (movingMs < engine->lifeMs[index]);
+      engine->lifeMs[index] -= alive ? movingMs : engine->lifeMs[index];
+    }
+    
+    if (alive && engine->handlers.update != NULL) {
+      alive = engine->handlers.update(engine, index, engine->context);
+    }
+    
+    // The last particle takes the place of a removed one, so stay on this index.
+    if (alive) {
+      GPoint newPoint = ParticleEngineGetPoint(engine, index);
+      engine->changed |= (gpoint_equal(&oldPoint, &newPoint) == false);
+      index++;
+      
+    } else {
+      removeParticle(engine, index);
+      engine->changed = true;
+    }
+  }
+}
+
+void ParticleEngineDraw(ParticleEngine *engine, GContext *ctx) {
+  if (engine->handlers.draw == NULL) {
+    return;
+  }
+  
+  for (uint16_t index = 0; index < engine->count; index++) {
+    engine->handlers.draw(engine, index, ctx, engine->context);
+  }
+}
+
+// Shrinks the layer to the box around the particles, so a change only invalidates the area
+// they cover rather than the whole screen. The bounds are offset to keep the particles in
+// screen coordinates. Does nothing if no particle has visibly changed since the last call.
+void ParticleEngineFitLayer(ParticleEngine *engine, Layer *layer) {
+  if (engine->changed == false) {
+    return;
+  }
+  
+  engine->changed = false;
+  
+  int16_t left = SCREEN_WIDTH;
+  int16_t top = SCREEN_HEIGHT;
+  int16_t right = 0;
+  int16_t bottom = 0;
+  for (uint16_t index = 0; index < engine->count; index++) {
+    GRect rect = getParticleRect(engine, index);
+    left = (rect.origin.x < left) ? rect.origin.x : left;
+    top = (rect.origin.y < top) ? rect.origin.y : top;
+    right = (rect.origin.x + rect.size.w > right) ? rect.origin.x + rect.size.w : right;
+    bottom = (rect.origin.y + rect.size.h > bottom) ? rect.origin.y + rect.size.h : bottom;
+  }
+  
+  GRect frame = GRectZero;
+  if (right > left && bottom > top) {
+    frame = GRect(left, top, right - left, bottom - top);
+  }
+  
+  // Moving the frame invalidates where the layer was as well as where it is now.
+  layer_set_frame(layer, frame);
+  layer_set_bounds(layer, GRect(0 - frame.origin.x, 0 - frame.origin.y, SCREEN_WIDTH, SCREEN_HEIGHT));
+  layer_mark_dirty(layer);
+}
+
+GPoint ParticleEngineGetPoint(ParticleEngine *engine, uint16_t index) {
+  return GPoint(PARTICLE_INT(engine->x[index]), PARTICLE_INT(engine->y[index]));
+}
+
+static void removeParticle(ParticleEngine *engine, uint16_t index) {
+  uint16_t last = --engine->count;
+  if (index == last) {
+    return;
+  }
+  
+  engine->x[index] = engine->x[last];
+  engine->y[index] = engine->y[last];
+  engine->velocityX[index] = engine->velocityX[last];
+  engine->velocityY[index] = engine->velocityY[last];
+  engine->delayMs[index] = engine->delayMs[last];
+  engine->lifeMs[index] = engine->lifeMs[last];
+  engine->size[index] = engine->size[last];
+}
+
+static GRect getParticleRect(ParticleEngine *engine, uint16_t index) {
+  GPoint point = ParticleEngineGetPoint(engine, index);
+  int16_t size = engine->size[index];
+  
+  return GRect(point.x - size - (engine->extent.w / 2), point.y - size - (engine->extent.h / 2),
+               (size * 2) + engine->extent.w, (size * 2) + engine->extent.h);
+}
\ No newline at end of file
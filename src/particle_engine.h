@@ -0,0 +1,51 @@
+#pragma once
+#include "common.h"
+
+#define MAX_PARTICLES 16
+
+// Positions and velocities are fixed point with PARTICLE_FIXED_SHIFT fraction bits. Values
+// are scaled by multiplying, as they can be negative.
+#define PARTICLE_FIXED_SHIFT 8
+#define PARTICLE_FIXED(value) ((int32_t) (value) * (1 << PARTICLE_FIXED_SHIFT))
+#define PARTICLE_INT(fixed) ((int16_t) ((fixed) >> PARTICLE_FIXED_SHIFT))
+
+// Particles with this life are only removed by their update handler.
+#define PARTICLE_LIFE_UNLIMITED INT16_MAX
+
+typedef struct ParticleEngine ParticleEngine;
+
+// Called for each moving particle after every step. Returns false to remove the particle.
+typedef bool (*ParticleUpdateHandler)(ParticleEngine *engine, uint16_t index, void *context);
+
+// Called for each particle, including those still waiting for their delay to pass.
+typedef void (*ParticleDrawHandler)(ParticleEngine *engine, uint16_t index, GContext *ctx, void *context);
+
+typedef struct {
+  ParticleUpdateHandler update;
+  ParticleDrawHandler draw;
+} ParticleHandlers;
+
+// One array per field. Live particles are packed at the front and a finished particle is
+// replaced by the last one, so the order of particles changes as they are removed.
+struct ParticleEngine {
+  int32_t x[MAX_PARTICLES];
+  int32_t y[MAX_PARTICLES];
+  int32_t velocityX[MAX_PARTICLES];   // Fixed point pixels per second
+  int32_t velocityY[MAX_PARTICLES];
+  int16_t delayMs[MAX_PARTICLES];
+  int16_t lifeMs[MAX_PARTICLES];
+  uint8_t size[MAX_PARTICLES];
+  uint16_t count;
+  GSize extent;     // Drawn size of a particle of size 0, a particle reaches size further out
+  bool changed;     // A particle has appeared, moved by a pixel or gone since the last fit
+  ParticleHandlers handlers;
+  void *context;
+};
+
+void ParticleEngineInit(ParticleEngine *engine, ParticleHandlers handlers, GSize extent, void *context);
+bool ParticleEngineSpawn(ParticleEngine *engine, GPoint origin, int32_t velocityX, int32_t velocityY,
+                         int16_t delayMs, int16_t lifeMs, uint8_t size);
+void ParticleEngineStep(ParticleEngine *engine, uint32_t elapsedMs);
+void ParticleEngineDraw(ParticleEngine *engine, GContext *ctx);
+void ParticleEngineFitLayer(ParticleEngine *engine, Layer *layer);
+GPoint ParticleEngineGetPoint(ParticleEngine *engine, uint16_t index);
\ No newline at end of file
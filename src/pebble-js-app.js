@@ -1,4 +1,7 @@
 var CONSOLE_LOG = false;
+
+// Format of the KEY_SETTINGS_PACKED byte array, see PackedSetting in main.c.
+var PACKED_SETTINGS_FORMAT = 1;
 var _showConfiguration = false;
 
 Pebble.addEventListener("ready",
@@ -30,6 +33,10 @@ Pebble.addEventListener("appmessage",
         showSettings();
       }
     }
+
+    if (typeof(e.payload.KEY_PROFILE_SUMMARY) !== "undefined") {
+      console.log("Profile: " + e.payload.KEY_PROFILE_SUMMARY);
+    }
   }
 );
 
@@ -70,16 +77,21 @@ Pebble.addEventListener("webviewclosed",
       
       saveSettings(configuration);
 
+      // All settings go in one byte array, one byte each in the order main.c reads them.
       var dictionary = {
-        "KEY_CURRENT_VERSION" : parseInt(configuration.currentVersion),
-        "KEY_HOUR_VIBRATE" : parseInt(configuration.hourVibrate),
-        "KEY_HOUR_VIBRATE_START" : parseInt(configuration.hourVibrateStart),
-        "KEY_HOUR_VIBRATE_END" : parseInt(configuration.hourVibrateEnd),
-        "KEY_BLUETOOTH_VIBRATE" : parseInt(configuration.bluetoothVibrate),
-        "KEY_SCENE_OVERRIDE" : parseInt(configuration.sceneOverride),
-        "KEY_SHARK_VIBRATE" : parseInt(configuration.sharkVibrate),
-        "KEY_SHARK_VIBRATE_START" : parseInt(configuration.sharkVibrateStart),
-        "KEY_SHARK_VIBRATE_END" : parseInt(configuration.sharkVibrateEnd)
+        "KEY_SETTINGS_PACKED" : [
+          PACKED_SETTINGS_FORMAT,
+          parseInt(configuration.currentVersion),
+          parseInt(configuration.hourVibrate),
+          parseInt(configuration.hourVibrateStart),
+          parseInt(configuration.hourVibrateEnd),
+          parseInt(configuration.bluetoothVibrate),
+          parseInt(configuration.sceneOverride),
+          parseInt(configuration.sharkVibrate),
+          parseInt(configuration.sharkVibrateStart),
+          parseInt(configuration.sharkVibrateEnd),
+          parseInt(configuration.batterySaver)
+        ]
       };
   
       Pebble.sendAppMessage(dictionary,
@@ -105,12 +117,14 @@ function formatUrlVariables() {
   var sharkVibrate = getLocalInt("sharkVibrate", 1);
   var sharkVibrateStart = getLocalInt("sharkVibrateStart", 9);
   var sharkVibrateEnd = getLocalInt("sharkVibrateEnd", 18);
+  var batterySaver = getLocalInt("batterySaver", 1);
 	
   return ("installedVersion=" + installedVersion + "&hourVibrate=" + hourVibrate + 
           "&hourVibrateStart=" + hourVibrateStart + "&hourVibrateEnd=" + hourVibrateEnd + 
           "&bluetoothVibrate=" + bluetoothVibrate + "&sceneOverride=" + sceneOverride + 
           "&clock24Hour=" + clock24Hour + "&sharkVibrate=" + sharkVibrate + 
-          "&sharkVibrateStart=" + sharkVibrateStart + "&sharkVibrateEnd=" + sharkVibrateEnd);
+          "&sharkVibrateStart=" + sharkVibrateStart + "&sharkVibrateEnd=" + sharkVibrateEnd +
+          "&batterySaver=" + batterySaver);
 }
 
 function saveSettings(settings) {
@@ -123,6 +137,7 @@ function saveSettings(settings) {
   localStorage.setItem("sharkVibrate", parseInt(settings.sharkVibrate));  
   localStorage.setItem("sharkVibrateStart", parseInt(settings.sharkVibrateStart));  
   localStorage.setItem("sharkVibrateEnd", parseInt(settings.sharkVibrateEnd));  
+  localStorage.setItem("batterySaver", parseInt(settings.batterySaver));  
 }
 
 function showSettings() {
@@ -0,0 +1,530 @@
+#include <pebble.h>
+#include "profiler.h"
+
+#ifdef PROFILING_ON
+
+// The redirections in common.h must not apply to the real calls made below.
+#undef layer_set_update_proc
+#undef layer_destroy
+#undef animation_set_handlers
+#undef animation_schedule
+
+#define MAX_PROFILE_ENTRIES 24
+#define MAX_PROFILED_LAYERS 24
+#define MAX_PROFILED_ANIMATIONS 16
+#define PROFILE_LINE_SIZE 64
+#define MAX_HEAP_ENTRIES 16
+#define MAX_HEAP_DEPTH 4
+#define SCENE_COUNT (VALENTINES + 1)
+
+typedef enum { UPDATE_PROC, STOPPED_HANDLER, ANIMATION } ProfileType;
+
+// Times are in milliseconds, the finest clock the watch offers. For ANIMATION entries
+// calls is the number of runs and minMs/maxMs hold the slowest and fastest run in fps.
+typedef struct {
+  const char *name;
+  ProfileType type;
+  uint32_t calls;
+  uint32_t totalMs;
+  uint32_t minMs;
+  uint32_t maxMs;
+  uint32_t frames;
+} ProfileEntry;
+
+typedef struct {
+  Layer *layer;
+  LayerUpdateProc updateProc;
+  ProfileEntry *entry;
+} ProfiledLayer;
+
+typedef struct {
+  Animation *animation;
+  const AnimationImplementation *implementation;
+  AnimationHandlers handlers;
+  ProfileEntry *animationEntry;
+  ProfileEntry *stoppedEntry;
+  uint32_t firstFrameMs;
+  uint32_t lastFrameMs;
+  uint32_t frames;
+} ProfiledAnimation;
+
+// Bytes charged to name by PROFILE_HEAP. peakBytes includes what a Create needed for
+// a moment while it ran, as far as the samples saw it.
+typedef struct {
+  const char *name;
+  int32_t currentBytes;
+  int32_t peakBytes;
+} HeapEntry;
+
+// An open PROFILE_HEAP, with the heap used when it began and the most used since.
+typedef struct {
+  HeapEntry *entry;
+  size_t startUsed;
+  size_t maxUsed;
+} HeapMark;
+
+typedef struct {
+  size_t currentUsed;
+  size_t peakUsed;
+} SceneHeap;
+
+static const char *_sceneNames[SCENE_COUNT] = {
+  "none", "duck", "thanksgiving", "christmas", "friday13", "valentines"
+};
+
+static ProfileEntry _entries[MAX_PROFILE_ENTRIES];
+static ProfiledLayer _layers[MAX_PROFILED_LAYERS];
+static ProfiledAnimation _animations[MAX_PROFILED_ANIMATIONS];
+static HeapEntry _heapEntries[MAX_HEAP_ENTRIES];
+static HeapMark _heapMarks[MAX_HEAP_DEPTH];
+static uint16_t _heapDepth = 0;
+static SceneHeap _sceneHeaps[SCENE_COUNT];
+static SCENE _heapScene = UNDEFINED_SCENE;
+
+static void profiledUpdateProc(Layer *layer, GContext *ctx);
+static void profiledAnimationSetup(Animation *animation);
+static void profiledAnimationUpdate(Animation *animation, const uint32_t distance_normalized);
+static void profiledAnimationTeardown(Animation *animation);
+static void profiledStartedHandler(Animation *animation, void *context);
+static void profiledStoppedHandler(Animation *animation, bool finished, void *context);
+static ProfileEntry* getEntry(const char *name, ProfileType type);
+static ProfiledLayer* findLayer(Layer *layer);
+static ProfiledAnimation* findAnimation(Animation *animation);
+static ProfiledAnimation* getAnimation(Animation *animation);
+static void recordCall(ProfileEntry *entry, uint32_t elapsedMs);
+static void recordAnimationRun(ProfiledAnimation *profiled);
+static HeapEntry* getHeapEntry(const char *name);
+static uint16_t appendLine(char *buffer, uint16_t length, uint16_t size, const char *line);
+
+static const AnimationImplementation _profiledImplementation = {
+  .setup = profiledAnimationSetup,
+  .update = profiledAnimationUpdate,
+  .teardown = profiledAnimationTeardown,
+};
+
+void ProfileSetUpdateProc(Layer *layer, LayerUpdateProc updateProc, const char *name) {
+  ProfiledLayer *profiled = findLayer(layer);
+  if (profiled == NULL && updateProc != NULL) {
+    profiled = findLayer(NULL);
+  }
+
+  if (profiled == NULL) {
+    layer_set_update_proc(layer, updateProc);
+    return;
+  }
+
+  if (updateProc == NULL) {
+    memset(profiled, 0, sizeof(ProfiledLayer));
+    layer_set_update_proc(layer, NULL);
+    return;
+  }
+
+  profiled->layer = layer;
+  profiled->updateProc = updateProc;
+  profiled->entry = getEntry(name, UPDATE_PROC);
+  layer_set_update_proc(layer, profiledUpdateProc);
+}
+
+void ProfileDestroyLayer(Layer *layer) {
+  ProfiledLayer *profiled = findLayer(layer);
+  if (profiled != NULL && layer != NULL) {
+    memset(profiled, 0, sizeof(ProfiledLayer));
+  }
+
+  layer_destroy(layer);
+}
+
+void ProfileSetAnimationHandlers(Animation *animation, AnimationHandlers handlers, void *context, const char *name) {
+  ProfiledAnimation *profiled = getAnimation(animation);
+  if (profiled == NULL) {
+    animation_set_handlers(animation, handlers, context);
+    return;
+  }
+
+  profiled->handlers = handlers;
+  animation_set_handlers(animation, (AnimationHandlers) {
+    .started = profiledStartedHandler,
+    .stopped = profiledStoppedHandler,
+  }, context);
+  profiled->stoppedEntry = (handlers.stopped != NULL) ? getEntry(name, STOPPED_HANDLER) : NULL;
+}
+
+void ProfileScheduleAnimation(Animation *animation, const char *name) {
+  // Rescheduling stops the animation first, which hands it back to the caller.
+  if (animation_is_scheduled(animation)) {
+    animation_unschedule(animation);
+  }
+
+  ProfiledAnimation *profiled = getAnimation(animation);
+  if (profiled == NULL) {
+    animation_schedule(animation);
+    return;
+  }
+
+  if (animation->implementation != &_profiledImplementation) {
+    profiled->implementation = animation->implementation;
+    animation_set_implementation(animation, &_profiledImplementation);
+  }
+
+  profiled->animationEntry = getEntry(name, ANIMATION);
+  profiled->frames = 0;
+  animation_schedule(animation);
+}
+
+void ProfileHeapBegin(const char *name) {
+  size_t used = heap_bytes_used();
+  ProfileHeapChanged(used);
+
+  if (_heapDepth < MAX_HEAP_DEPTH) {
+    _heapMarks[_heapDepth++] = (HeapMark) {
+      .entry = getHeapEntry(name),
+      .startUsed = used,
+      .maxUsed = used,
+    };
+  }
+}
+
+void ProfileHeapEnd(const char *name) {
+  size_t used = heap_bytes_used();
+  ProfileHeapChanged(used);
+
+  if (_heapDepth == 0) {
+    return;
+  }
+
+  HeapMark *mark = &_heapMarks[--_heapDepth];
+  int32_t delta = (int32_t) used - (int32_t) mark->startUsed;
+  int32_t transientPeak = mark->entry->currentBytes + (int32_t) (mark->maxUsed - mark->startUsed);
+
+  mark->entry->currentBytes += delta;
+  if (transientPeak > mark->entry->peakBytes) {
+    mark->entry->peakBytes = transientPeak;
+  }
+
+  if (mark->entry->currentBytes > mark->entry->peakBytes) {
+    mark->entry->peakBytes = mark->entry->currentBytes;
+  }
+
+  // What a nested Create took belongs to it alone, not to the one it ran inside.
+  if (_heapDepth > 0) {
+    _heapMarks[_heapDepth - 1].startUsed += delta;
+  }
+}
+
+void ProfileHeapScene(SCENE scene) {
+  _heapScene = scene;
+  _sceneHeaps[scene].peakUsed = 0;
+  ProfileHeapChanged(heap_bytes_used());
+}
+
+void ProfileHeapChanged(size_t used) {
+  for (uint16_t depth = 0; depth < _heapDepth; depth++) {
+    if (used > _heapMarks[depth].maxUsed) {
+      _heapMarks[depth].maxUsed = used;
+    }
+  }
+
+  SceneHeap *sceneHeap = &_sceneHeaps[_heapScene];
+  sceneHeap->currentUsed = used;
+  if (used > sceneHeap->peakUsed) {
+    sceneHeap->peakUsed = used;
+  }
+}
+
+uint16_t ProfileSummary(char *buffer, uint16_t size) {
+  uint16_t length = 0;
+  buffer[0] = '\0';
+
+  for (uint16_t index = 0; index < MAX_PROFILE_ENTRIES; index++) {
+    ProfileEntry *entry = &_entries[index];
+    if (entry->name == NULL || entry->calls == 0) {
+      continue;
+    }
+
+    char line[PROFILE_LINE_SIZE];
+    if (entry->type == ANIMATION) {
+      uint32_t fps = (entry->totalMs > 0) ? (entry->frames * 1000 / entry->totalMs) : 0;
+      snprintf(line, sizeof(line), "%s anim %ix %ifps (%i-%i)", entry->name, (int) entry->calls, (int) fps,
+               (int) entry->minMs, (int) entry->maxMs);
+
+    } else {
+      uint32_t averageTenths = entry->totalMs * 10 / entry->calls;
+      snprintf(line, sizeof(line), "%s%s %ix %i/%i.%i/%ims", entry->name,
+               (entry->type == STOPPED_HANDLER) ? " stopped" : "", (int) entry->calls, (int) entry->minMs,
+               (int) (averageTenths / 10), (int) (averageTenths % 10), (int) entry->maxMs);
+    }
+
+    length = appendLine(buffer, length, size, line);
+
+    entry->calls = 0;
+    entry->totalMs = 0;
+    entry->minMs = 0;
+    entry->maxMs = 0;
+    entry->frames = 0;
+  }
+
+  // Heap figures are not per period, they cover the whole run.
+  ProfileHeapChanged(heap_bytes_used());
+
+  for (uint16_t index = 0; index < MAX_HEAP_ENTRIES; index++) {
+    HeapEntry *entry = &_heapEntries[index];
+    if (entry->name == NULL) {
+      continue;
+    }
+
+    char line[PROFILE_LINE_SIZE];
+    snprintf(line, sizeof(line), "%s heap %i/%iB", entry->name, (int) entry->currentBytes,
+             (int) entry->peakBytes);
+    length = appendLine(buffer, length, size, line);
+  }
+
+  for (uint16_t scene = 0; scene < SCENE_COUNT; scene++) {
+    SceneHeap *sceneHeap = &_sceneHeaps[scene];
+    if (sceneHeap->peakUsed == 0) {
+      continue;
+    }
+
+    char line[PROFILE_LINE_SIZE];
+    snprintf(line, sizeof(line), "%s scene heap %i/%iB%s", _sceneNames[scene], (int) sceneHeap->currentUsed,
+             (int) sceneHeap->peakUsed, (scene == _heapScene) ? " now" : "");
+    length = appendLine(buffer, length, size, line);
+  }
+
+  return length;
+}
+
+static void profiledUpdateProc(Layer *layer, GContext *ctx) {
+  ProfiledLayer *profiled = findLayer(layer);
+  if (profiled == NULL) {
+    return;
+  }
+
+  uint32_t start = NowMs();
+  profiled->updateProc(layer, ctx);
+  recordCall(profiled->entry, NowMs() - start);
+
+  // The watch has no allocation hook, so drawing is where the heap is sampled between
+  // PROFILE_HEAP marks.
+  ProfileHeapChanged(heap_bytes_used());
+}
+
+static void profiledAnimationSetup(Animation *animation) {
+  ProfiledAnimation *profiled = findAnimation(animation);
+  if (profiled != NULL && profiled->implementation != NULL && profiled->implementation->setup != NULL) {
+    profiled->implementation->setup(animation);
+  }
+}
+
+static void profiledAnimationUpdate(Animation *animation, const uint32_t distance_normalized) {
+  ProfiledAnimation *profiled = findAnimation(animation);
+  if (profiled == NULL || profiled->implementation == NULL) {
+    return;
+  }
+
+  uint32_t now = NowMs();
+  if (profiled->frames == 0) {
+    profiled->firstFrameMs = now;
+  }
+
+  profiled->lastFrameMs = now;
+  profiled->frames++;
+
+  if (profiled->implementation->update != NULL) {
+    profiled->implementation->update(animation, distance_normalized);
+  }
+}
+
+static void profiledAnimationTeardown(Animation *animation) {
+  ProfiledAnimation *profiled = findAnimation(animation);
+  if (profiled != NULL && profiled->implementation != NULL && profiled->implementation->teardown != NULL) {
+    profiled->implementation->teardown(animation);
+  }
+}
+
+static void profiledStartedHandler(Animation *animation, void *context) {
+  ProfiledAnimation *profiled = findAnimation(animation);
+  if (profiled != NULL && profiled->handlers.started != NULL) {
+    profiled->handlers.started(animation, context);
+  }
+}
+
+static void profiledStoppedHandler(Animation *animation, bool finished, void *context) {
+  ProfiledAnimation *profiled = findAnimation(animation);
+  if (profiled == NULL) {
+    return;
+  }
+  
+  AnimationHandlers handlers = profiled->handlers;
+  void *handlerContext = context;
+  ProfileEntry *stoppedEntry = profiled->stoppedEntry;
+
+  recordAnimationRun(profiled);
+
+  // Hand the animation back before the stopped handler runs, as the handler may
+  // destroy or reschedule it.
+  if (profiled->implementation != NULL) {
+    animation_set_implementation(animation, profiled->implementation);
+  }
+
+  animation_set_handlers(animation, handlers, handlerContext);
+  memset(profiled, 0, sizeof(ProfiledAnimation));
+
+  if (handlers.stopped != NULL) {
+    uint32_t start = NowMs();
+    handlers.stopped(animation, finished, handlerContext);
+    recordCall(stoppedEntry, NowMs() - start);
+  }
+}
+
+static ProfileEntry* getEntry(const char *name, ProfileType type) {
+  ProfileEntry *freeEntry = NULL;
+
+  for (uint16_t index = 0; index < MAX_PROFILE_ENTRIES; index++) {
+    if (_entries[index].name == NULL) {
+      if (freeEntry == NULL) {
+        freeEntry = &_entries[index];
+      }
+
+    } else if (_entries[index].type == type && strcmp(_entries[index].name, name) == 0) {
+      return &_entries[index];
+    }
+  }
+
+  if (freeEntry != NULL) {
+    freeEntry->name = name;
+    freeEntry->type = type;
+  }
+
+  return freeEntry;
+}
+
+static HeapEntry* getHeapEntry(const char *name) {
+  HeapEntry *freeEntry = NULL;
+
+  for (uint16_t index = 0; index < MAX_HEAP_ENTRIES; index++) {
+    if (_heapEntries[index].name == NULL) {
+      if (freeEntry == NULL) {
+        freeEntry = &_heapEntries[index];
+      }
+
+    } else if (strcmp(_heapEntries[index].name, name) == 0) {
+      return &_heapEntries[index];
+    }
+  }
+
+  // Out of entries, the last one collects the rest.
+  if (freeEntry == NULL) {
+    return &_heapEntries[MAX_HEAP_ENTRIES - 1];
+  }
+
+  freeEntry->name = name;
+  return freeEntry;
+}
+
+static ProfiledLayer* findLayer(Layer *layer) {
+  for (uint16_t index = 0; index < MAX_PROFILED_LAYERS; index++) {
+    if (_layers[index].layer == layer) {
+      return &_layers[index];
+    }
+  }
+
+  return NULL;
+}
+
+static ProfiledAnimation* findAnimation(Animation *animation) {
+  for (uint16_t index = 0; index < MAX_PROFILED_ANIMATIONS; index++) {
+    if (_animations[index].animation == animation) {
+      return &_animations[index];
+    }
+  }
+
+  return NULL;
+}
+
+// Returns the profiling slot for the animation, claiming a free one and routing the
+// animation's handlers through the profiler if it is not being profiled yet.
+static ProfiledAnimation* getAnimation(Animation *animation) {
+  ProfiledAnimation *profiled = findAnimation(animation);
+  if (profiled != NULL) {
+    return profiled;
+  }
+
+  profiled = findAnimation(NULL);
+  if (profiled == NULL) {
+    return NULL;
+  }
+
+  // The animation keeps its own context so animation_get_context() still works, the
+  // handlers find their slot from the animation instead.
+  profiled->animation = animation;
+  profiled->handlers = animation->handlers;
+  animation_set_handlers(animation, (AnimationHandlers) {
+    .started = profiledStartedHandler,
+    .stopped = profiledStoppedHandler,
+  }, animation->context);
+
+  return profiled;
+}
+
+// Logs the line and adds it to the summary in buffer if it fits. Returns the new length.
+static uint16_t appendLine(char *buffer, uint16_t length, uint16_t size, const char *line) {
+  MY_APP_LOG(APP_LOG_LEVEL_INFO, "Profile: %s", line);
+
+  uint16_t lineLength = strlen(line);
+  if (length + lineLength + 2 < size) {
+    if (length > 0) {
+      buffer[length++] = ';';
+    }
+
+    memcpy(&buffer[length], line, lineLength + 1);
+    length += lineLength;
+  }
+
+  return length;
+}
+
+static void recordCall(ProfileEntry *entry, uint32_t elapsedMs) {
+  if (entry == NULL) {
+    return;
+  }
+
+  if (entry->calls == 0 || elapsedMs < entry->minMs) {
+    entry->minMs = elapsedMs;
+  }
+
+  if (elapsedMs > entry->maxMs) {
+    entry->maxMs = elapsedMs;
+  }
+
+  entry->calls++;
+  entry->totalMs += elapsedMs;
+}
+
+static void recordAnimationRun(ProfiledAnimation *profiled) {
+  ProfileEntry *entry = profiled->animationEntry;
+  if (entry == NULL || profiled->frames < 2) {
+    return;
+  }
+
+  // Frames are counted between the first and the last update, so a run of n updates
+  // covers n - 1 frame intervals.
+  uint32_t elapsedMs = profiled->lastFrameMs - profiled->firstFrameMs;
+  if (elapsedMs == 0) {
+    return;
+  }
+
+  uint32_t fps = (profiled->frames - 1) * 1000 / elapsedMs;
+  if (entry->calls == 0 || fps < entry->minMs) {
+    entry->minMs = fps;
+  }
+
+  if (fps > entry->maxMs) {
+    entry->maxMs = fps;
+  }
+
+  entry->calls++;
+  entry->frames += profiled->frames - 1;
+  entry->totalMs += elapsedMs;
+}
+
+#endif
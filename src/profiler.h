@@ -0,0 +1,26 @@
+#pragma once
+#include "common.h"
+
+// Instrumentation for PROFILING_ON builds. common.h redirects layer_set_update_proc,
+// layer_destroy, animation_set_handlers and animation_schedule here, so every update
+// proc, stopped handler and running animation is measured without changing the layers.
+
+void ProfileSetUpdateProc(Layer *layer, LayerUpdateProc updateProc, const char *name);
+void ProfileDestroyLayer(Layer *layer);
+void ProfileSetAnimationHandlers(Animation *animation, AnimationHandlers handlers, void *context, const char *name);
+void ProfileScheduleAnimation(Animation *animation, const char *name);
+
+// Heap accounting, see PROFILE_HEAP in common.h. The heap taken between Begin and End
+// is charged to name, so a Create and its Destroy net out to what the object still holds.
+// The heap used while each scene is showing is tracked from ProfileHeapScene on.
+void ProfileHeapBegin(const char *name);
+void ProfileHeapEnd(const char *name);
+void ProfileHeapScene(SCENE scene);
+
+// The watch can only sample heap_bytes_used(). The host build's allocator calls this
+// after every allocation and free, so there the peaks are exact.
+void ProfileHeapChanged(size_t used);
+
+// Writes the summary for the period since the last call into buffer, logs it and
+// starts a new period. Returns the length of the summary.
+uint16_t ProfileSummary(char *buffer, uint16_t size);
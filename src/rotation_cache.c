@@ -0,0 +1,208 @@
+#include <pebble.h>
+#include "rotation_cache.h"
+#include "bitmap_cache.h"
+
+#define MAX_ROTATED_BITMAPS 4
+
+// Bytes in a rendering of an image with the given hypotenuse. Rows are whole words.
+#define ROTATED_BITMAP_BYTES(hypotenuse) ((((hypotenuse) + 31) / 32) * 4 * (hypotenuse))
+
+// Upper bound on rendered bytes held by the cache, in use or not. One rendering at the
+// largest hypotenuse, or the duck's current pose and the one before it at smaller ones.
+#define ROTATION_CACHE_BUDGET ROTATED_BITMAP_BYTES(MAX_IMAGE_HYPOTENUSE)
+
+typedef struct {
+  uint32_t resourceId;
+  int32_t angle;        // Angle in degrees
+  GBitmap *bitmap;
+  uint16_t refCount;
+  uint16_t bytes;
+  uint32_t lastUsed;
+} RotatedBitmap;
+
+static RotatedBitmap _cache[MAX_ROTATED_BITMAPS];
+static uint32_t _cacheBytes = 0;
+static uint32_t _useCounter = 0;
+
+static RotatedBitmap* findRotatedBitmap(uint32_t resourceId, int32_t angle);
+static RotatedBitmap* findIdleBitmap(uint16_t size);
+static void evictIdleBitmap(RotatedBitmap *entry);
+static void trimCache(uint32_t neededBytes);
+static void renderRotatedBitmap(const GBitmap *source, GBitmap *rendering, int32_t angle);
+static int32_t roundRatio(int32_t value);
+
+GBitmap* RotationCacheAcquire(uint32_t resourceId, int32_t angle) {
+  RotatedBitmap *entry = findRotatedBitmap(resourceId, angle);
+  
+  if (entry == NULL) {
+    uint16_t hypotenuse = GetImageHypotenuse(resourceId);
+    if (hypotenuse == 0) {
+      return NULL;
+    }
+    
+    // Render over an idle rendering of the same size when there is one, which saves
+    // freeing and allocating the same amount of heap.
+    GBitmap *bitmap = NULL;
+    entry = findIdleBitmap(hypotenuse);
+    if (entry != NULL) {
+      bitmap = entry->bitmap;
+      _cacheBytes -= entry->bytes;
+      
+    } else {
+      trimCache(ROTATED_BITMAP_BYTES(hypotenuse));
+      entry = findRotatedBitmap(0, 0);
+      if (entry == NULL) {
+        entry = findIdleBitmap(0);
+        evictIdleBitmap(entry);
+      }
+      
+      if (entry == NULL) {
+        MY_APP_LOG(APP_LOG_LEVEL_WARNING, "Rotation cache full, resource %i not rendered", (int) resourceId);
+        return NULL;
+      }
+      
+      bitmap = gbitmap_create_blank(GSize(hypotenuse, hypotenuse));
+      if (bitmap == NULL) {
+        memset(entry, 0, sizeof(RotatedBitmap));
+        return NULL;
+      }
+    }
+    
+    GBitmap *source = BitmapCacheAcquire(resourceId);
+    if (source == NULL) {
+      gbitmap_destroy(bitmap);
+      memset(entry, 0, sizeof(RotatedBitmap));
+      return NULL;
+    }
+    
+    renderRotatedBitmap(source, bitmap, angle);
+    BitmapCacheRelease(resourceId);
+    
+    entry->resourceId = resourceId;
+    entry->angle = angle;
+    entry->bitmap = bitmap;
+    entry->refCount = 0;
+    entry->bytes = bitmap->row_size_bytes * bitmap->bounds.size.h;
+    _cacheBytes += entry->bytes;
+  }
+  
+  entry->refCount++;
+  entry->lastUsed = ++_useCounter;
+  return entry->bitmap;
+}
+
+void RotationCacheRelease(GBitmap *bitmap) {
+  for (int index = 0; index < MAX_ROTATED_BITMAPS; index++) {
+    RotatedBitmap *entry = &_cache[index];
+    if (entry->bitmap == bitmap && bitmap != NULL && entry->refCount > 0) {
+      entry->refCount--;
+      if (entry->refCount == 0) {
+        trimCache(0);
+      }
+      
+      return;
+    }
+  }
+}
+
+void DestroyRotationCache() {
+  for (int index = 0; index < MAX_ROTATED_BITMAPS; index++) {
+    if (_cache[index].bitmap != NULL) {
+      gbitmap_destroy(_cache[index].bitmap);
+    }
+  }
+  
+  memset(_cache, 0, sizeof(_cache));
+  _cacheBytes = 0;
+}
+
+static RotatedBitmap* findRotatedBitmap(uint32_t resourceId, int32_t angle) {
+  for (int index = 0; index < MAX_ROTATED_BITMAPS; index++) {
+    if (_cache[index].resourceId == resourceId && _cache[index].angle == angle) {
+      return &_cache[index];
+    }
+  }
+  
+  return NULL;
+}
+
+// Returns the least recently used rendering nothing references, of the given width
+// unless size is 0. Returns NULL if there is none.
+static RotatedBitmap* findIdleBitmap(uint16_t size) {
+  RotatedBitmap *oldest = NULL;
+  
+  for (int index = 0; index < MAX_ROTATED_BITMAPS; index++) {
+    RotatedBitmap *entry = &_cache[index];
+    if (entry->bitmap != NULL && entry->refCount == 0 && (size == 0 || entry->bitmap->bounds.size.w == size) &&
+        (oldest == NULL || entry->lastUsed < oldest->lastUsed)) {
+      oldest = entry;
+    }
+  }
+  
+  return oldest;
+}
+
+static void evictIdleBitmap(RotatedBitmap *entry) {
+  if (entry == NULL) {
+    return;
+  }
+  
+  gbitmap_destroy(entry->bitmap);
+  _cacheBytes -= entry->bytes;
+  memset(entry, 0, sizeof(RotatedBitmap));
+}
+
+static void trimCache(uint32_t neededBytes) {
+  RotatedBitmap *entry;
+  while (_cacheBytes + neededBytes > ROTATION_CACHE_BUDGET && (entry = findIdleBitmap(0)) != NULL) {
+    evictIdleBitmap(entry);
+  }
+}
+
+// Maps every pixel of the rendering back into the source about both centers, the way a
+// RotBitmapLayer draws. Only black source pixels are copied, everything else stays white.
+static void renderRotatedBitmap(const GBitmap *source, GBitmap *rendering, int32_t angle) {
+  uint8_t *renderingData = (uint8_t*) rendering->addr;
+  memset(renderingData, 0xff, rendering->row_size_bytes * rendering->bounds.size.h);
+  if (source == NULL) {
+    return;
+  }
+  
+  const uint8_t *sourceData = (const uint8_t*) source->addr;
+  int32_t sine = sin_lookup(PEBBLE_ANGLE_FROM_DEGREE(angle));
+  int32_t cosine = cos_lookup(PEBBLE_ANGLE_FROM_DEGREE(angle));
+  int16_t sourceCenterX = source->bounds.size.w / 2;
+  int16_t sourceCenterY = source->bounds.size.h / 2;
+  int16_t center = rendering->bounds.size.w / 2;
+  
+  for (int16_t y = 0; y < rendering->bounds.size.h; y++) {
+    int32_t dy = y - center;
+    
+    for (int16_t x = 0; x < rendering->bounds.size.w; x++) {
+      int32_t dx = x - center;
+      
+      int16_t sourceX = sourceCenterX + roundRatio(dx * cosine + dy * sine);
+      int16_t sourceY = sourceCenterY + roundRatio(dy * cosine - dx * sine);
+      if (sourceX < 0 || sourceY < 0 || sourceX >= source->bounds.size.w || sourceY >= source->bounds.size.h) {
+        continue;
+      }
+      
+      sourceX += source->bounds.origin.x;
+      sourceY += source->bounds.origin.y;
+      if ((sourceData[sourceY * source->row_size_bytes + sourceX / 8] & (1 << (sourceX % 8))) == 0) {
+        renderingData[y * rendering->row_size_bytes + x / 8] &= ~(1 << (x % 8));
+      }
+    }
+  }
+}
+
+// Divides by TRIG_MAX_RATIO rounding to the nearest whole number, halves rounding up.
+static int32_t roundRatio(int32_t value) {
+  int32_t numerator = 2 * value + TRIG_MAX_RATIO;
+  int32_t quotient = numerator / (2 * TRIG_MAX_RATIO);
+  if (numerator < 0 && numerator % (2 * TRIG_MAX_RATIO) != 0) {
+    quotient--;
+  }
+  
+  return quotient;
+}
\ No newline at end of file
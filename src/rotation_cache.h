@@ -0,0 +1,12 @@
+#pragma once
+#include "common.h"
+
+// Cache of image resources rendered at an angle, so a rotated sprite is only rotated
+// when its image or angle changes rather than on every redraw. Renderings are square,
+// the image's hypotenuse on each side, with the image centered on white. Every
+// RotationCacheAcquire must be paired with a RotationCacheRelease of the bitmap it
+// returned.
+
+GBitmap* RotationCacheAcquire(uint32_t resourceId, int32_t angle);
+void RotationCacheRelease(GBitmap *bitmap);
+void DestroyRotationCache();
\ No newline at end of file
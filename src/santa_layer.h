@@ -3,6 +3,7 @@
   
 typedef struct {
   BitmapGroup santa;
+  FrameAnimation passAnimation;
   int16_t lastUpdateMinute;
 } SantaLayerData;
 
@@ -3,28 +3,49 @@
 
 #define FIRST_SHARK_PASS_MINUTE 20
 
-#define SHARK_LEFT_WIDTH 88
-  
-// Have the shark pass under the duck by PASS_OFFSET_Y y coordinates.
-#define PASS_OFFSET_Y 15
-#define PASS_POST_EAT_OFFSET_Y -7
   
 // Control speed of eat animation. Units are milliseconds per coordinate X.
 #define EAT_ANIMATION_SPEED_FACTOR 30
 
 #define OFF_SCREEN_LEFT_COORD -998
 
+// The eat sequence always swims the shark from the right edge until it is off the left
+// edge, only its height and frame depend on the duck.
+#define EAT_DISTANCE (SCREEN_WIDTH + IMAGE_SHARK_LEFT_WIDTH)
+#define EAT_START_Y 24
+
+#define SWIM_UP(next, frame, offsetX) { next, frame, { offsetX, -2 }, true, true }
+#define SWIM_DOWN(next, frame) { next, frame, { -5, 2 }, true, false }
+#define SWIM_AWAY { EAT_FINISHED, FRAME_LEFT, { 0 - IMAGE_SHARK_LEFT_WIDTH, 36 }, false, false }
+
 typedef enum { SHARK_UNDEFINED, SHARK_PASS, SHARK_EAT } SharkAnimationType;
 
 typedef enum { EAT_INITIAL, EAT_LEFT, EAT_OPEN_1, EAT_OPEN_2, EAT_OPEN_3, EAT_OPEN_4, EAT_OPEN_5, 
                EAT_1, EAT_2, EAT_3, EAT_4, EAT_FINISHED } EatState;
 
+// Frames in the order they are stacked in the IMAGE_SHARK_EAT_STRIP resource.
+typedef enum { FRAME_LEFT, FRAME_OPEN_1, FRAME_OPEN_2, FRAME_OPEN_3, FRAME_OPEN_4, FRAME_OPEN_5,
+               FRAME_EAT_1, FRAME_EAT_2, FRAME_EAT_3, FRAME_EAT_4, EAT_FRAME_COUNT } EatFrame;
+
 typedef struct {
   EatState state;
+  GPoint startPoint;
   GPoint endPoint;
   bool up;   // Moving up
+  int32_t elapsedMs;   // Negative while the start is delayed
+  uint32_t durationMs;
 } EatStateMachine;
 
+// A step of the eat sequence. Relative steps move the shark by offset from where the
+// previous step ended, the others swim it to offset in screen coordinates.
+typedef struct {
+  EatState next;
+  EatFrame frame;
+  GPoint offset;
+  bool relative;
+  bool up;
+} EatTransition;
+
 typedef struct {
   SharkAnimationType type;
   uint32_t duration;
@@ -47,25 +68,42 @@ static const uint32_t _jawsMusic[] = {
 };
 */
 
-static PropertyAnimation *_animation = NULL;
-static SharkAnimationType _animationType = SHARK_UNDEFINED;
-static AppTimer *_eatTimer = NULL;
+// The transitions out of each state. The first is taken while the shark is moving up and
+// the duck is still there to be eaten, the second otherwise.
+static const EatTransition _eatTransitions[EAT_FINISHED][2] = {
+  [EAT_INITIAL] = { { EAT_LEFT, FRAME_LEFT, { 98, 10 }, false, true }, SWIM_AWAY },
+  [EAT_LEFT] = { SWIM_UP(EAT_OPEN_1, FRAME_OPEN_1, -5), SWIM_AWAY },
+  [EAT_OPEN_1] = { SWIM_UP(EAT_OPEN_2, FRAME_OPEN_2, -5), SWIM_AWAY },
+  [EAT_OPEN_2] = { SWIM_UP(EAT_OPEN_3, FRAME_OPEN_3, -5), SWIM_DOWN(EAT_OPEN_1, FRAME_OPEN_1) },
+  [EAT_OPEN_3] = { SWIM_UP(EAT_OPEN_4, FRAME_OPEN_4, -5), SWIM_DOWN(EAT_OPEN_2, FRAME_OPEN_2) },
+  [EAT_OPEN_4] = { SWIM_UP(EAT_OPEN_5, FRAME_OPEN_5, -13), SWIM_DOWN(EAT_OPEN_3, FRAME_OPEN_3) },
+  [EAT_OPEN_5] = { SWIM_DOWN(EAT_1, FRAME_EAT_1), SWIM_DOWN(EAT_OPEN_4, FRAME_OPEN_4) },
+  [EAT_1] = { SWIM_DOWN(EAT_2, FRAME_EAT_2), SWIM_DOWN(EAT_2, FRAME_EAT_2) },
+  [EAT_2] = { SWIM_DOWN(EAT_3, FRAME_EAT_3), SWIM_DOWN(EAT_3, FRAME_EAT_3) },
+  [EAT_3] = { SWIM_DOWN(EAT_4, FRAME_EAT_4), SWIM_DOWN(EAT_4, FRAME_EAT_4) },
+  [EAT_4] = { SWIM_DOWN(EAT_OPEN_2, FRAME_OPEN_2), SWIM_DOWN(EAT_OPEN_2, FRAME_OPEN_2) },
+};
+
 static EatStateMachine _eatState;
+static SharkLayerData *_eatData = NULL;
+static GBitmap *_eatFrameBitmap = NULL;
 
 static void runAnimation(SharkLayerData* data, SharkAnimation* sharkAnimation);
-static SharkAnimation* getSharkAnimation(SharkLayerData *data, uint16_t minute, uint16_t second, bool runNow, bool firstDisplay);
-static SharkAnimation* getEatAnimation(SharkLayerData *data);
-static void animationStoppedHandler(Animation *animation, bool finished, void *context);
-static void eatTimerCallback(void *callback_data);
+static bool getSharkAnimation(uint16_t minute, uint16_t second, bool runNow, bool firstDisplay, SharkAnimation *sharkAnimation);
+static void runEatAnimation(SharkLayerData *data, SharkAnimation *sharkAnimation);
+static bool eatFrameCallback(void *context, uint32_t elapsedMs);
+static void nextEatState(SharkLayerData *data);
+static void stopEatAnimation(SharkLayerData *data, bool showLeftPose);
+static bool isAnimationInProgress(SharkLayerData *data);
 static void resolveCoordinateSubstitution(GPoint *point, uint16_t objectWidth);
 
 SharkLayerData* CreateSharkLayer(Layer *relativeLayer, LayerRelation relation, DuckLayerData *duckData) {
   SharkLayerData* data = malloc(sizeof(SharkLayerData));
   if (data != NULL) {
     memset(data, 0, sizeof(SharkLayerData));
-    data->shark.layer = bitmap_layer_create(GRect(0, -5, 5, 5));
-    bitmap_layer_set_compositing_mode(data->shark.layer, GCompOpAnd);
-    AddLayer(relativeLayer, (Layer*) data->shark.layer, relation);    
+    InitBitmapGroup(&data->shark, GRect(0, -5, 5, 5));
+    AddLayer(relativeLayer, data->shark.layer, relation);    
+    InitFrameAnimation(&data->passAnimation, data->shark.layer);
     data->hidden = false;
     data->lastUpdateMinute = -1;
     data->duckData = duckData;
@@ -84,24 +122,26 @@ void DrawSharkLayer(SharkLayerData *data, uint16_t hour, uint16_t minute, uint16
   bool firstDisplay = (data->lastUpdateMinute == -1); 
   data->lastUpdateMinute = minute;
   
-  SharkAnimation *sharkAnimation = getSharkAnimation(data, minute, second, firstDisplay, firstDisplay);
-  if (sharkAnimation != NULL && _animation == NULL) {
-    runAnimation(data, sharkAnimation);
+  SharkAnimation sharkAnimation;
+  if (getSharkAnimation(minute, second, firstDisplay, firstDisplay, &sharkAnimation) && isAnimationInProgress(data) == false) {
+    runAnimation(data, &sharkAnimation);
   }
   
   // The duck layer is showing if watchface was loaded between 51:50 and 51:59, so hide it if
   // animation isn't running.
-  if (minute == SHARK_SCENE_EAT_MINUTE && _animation == NULL && data->duckData->hidden == false) {
+  if (minute == SHARK_SCENE_EAT_MINUTE && isAnimationInProgress(data) == false && data->duckData->hidden == false) {
     SetLayerHidden((Layer*) data->duckData->duck.layer, &data->duckData->hidden, true);
   }
-  
-  if (sharkAnimation != NULL) {
-    free(sharkAnimation);
-  }
 }
 
 void DestroySharkLayer(SharkLayerData *data) {
   if (data != NULL) {    
+    if (_eatData == data) {
+      FrameSchedulerRemove(eatFrameCallback, data);
+      stopEatAnimation(data, false);
+    }
+    
+    DestroyFrameAnimation(&data->passAnimation);
     DestroyBitmapGroup(&data->shark);
     free(data);
   }  
@@ -109,22 +149,29 @@ void DestroySharkLayer(SharkLayerData *data) {
 
 void HandleTapSharkLayer(SharkLayerData *data, uint16_t hour, uint16_t minute, uint16_t second) {
   // Exit if animation or rotation already running
-  if (_animation != NULL) {
+  if (isAnimationInProgress(data)) {
     return;
   }
   
   // Force animation on shake.
-  SharkAnimation *sharkAnimation = getSharkAnimation(data, minute, second, true, false);
-  if (sharkAnimation == NULL) {
+  SharkAnimation sharkAnimation;
+  if (getSharkAnimation(minute, second, true, false, &sharkAnimation) == false) {
     return;
   }
 
-  runAnimation(data, sharkAnimation);
-  free(sharkAnimation);
+  runAnimation(data, &sharkAnimation);
 }
 
 static void runAnimation(SharkLayerData *data, SharkAnimation *sharkAnimation) {
+  if (sharkAnimation->type == SHARK_EAT) {
+    runEatAnimation(data, sharkAnimation);
+    return;
+  }
+  
   BitmapGroupSetBitmap(&data->shark, sharkAnimation->resourceId);
+  if (data->shark.bitmap == NULL) {
+    return;
+  }
 
   resolveCoordinateSubstitution(&sharkAnimation->startPoint, data->shark.bitmap->bounds.size.w);
   resolveCoordinateSubstitution(&sharkAnimation->endPoint, data->shark.bitmap->bounds.size.w);
@@ -132,71 +179,61 @@ static void runAnimation(SharkLayerData *data, SharkAnimation *sharkAnimation) {
   GRect startFrame = (GRect) { .origin = sharkAnimation->startPoint, .size = data->shark.bitmap->bounds.size };
   GRect stopFrame = (GRect) { .origin = sharkAnimation->endPoint, .size = data->shark.bitmap->bounds.size };
   
-  layer_set_frame((Layer*) data->shark.layer, startFrame);    
-  layer_set_bounds((Layer*) data->shark.layer, GRect(0, 0, startFrame.size.w, startFrame.size.h));
-
-  // Create the animation and schedule it.
-  _animation = property_animation_create_layer_frame((Layer*) data->shark.layer, NULL, &stopFrame);
-  if (_animation != NULL) {
-    animation_set_duration((Animation*) _animation, sharkAnimation->duration);
-    animation_set_delay((Animation*) _animation, sharkAnimation->delay);
-    animation_set_curve((Animation*) _animation, AnimationCurveLinear);
-    animation_set_handlers((Animation*) _animation, (AnimationHandlers) {
-      .started = NULL,
-      .stopped = (AnimationStoppedHandler) animationStoppedHandler,
-    }, (void*) data);
-    
-    _animationType = sharkAnimation->type;
-    animation_schedule((Animation*) _animation);
+  layer_set_frame(data->shark.layer, startFrame);    
+
+  if (RetargetFrameAnimation(&data->passAnimation, stopFrame)) {
+    animation_set_duration(data->passAnimation.animation, sharkAnimation->duration);
+    animation_set_delay(data->passAnimation.animation, sharkAnimation->delay);
+    animation_set_curve(data->passAnimation.animation, AnimationCurveLinear);
+    animation_schedule(data->passAnimation.animation);
   }
 }
 
-static SharkAnimation* getSharkAnimation(SharkLayerData *data, uint16_t minute, uint16_t second, bool runNow, bool firstDisplay) {
+// Fills in the caller's sharkAnimation. Returns false if there is no animation to run.
+static bool getSharkAnimation(uint16_t minute, uint16_t second, bool runNow, bool firstDisplay, SharkAnimation *sharkAnimation) {
+  memset(sharkAnimation, 0, sizeof(SharkAnimation));
+
   if (minute == SHARK_SCENE_EAT_MINUTE) {
-    SharkAnimation *sharkAnimation = NULL;
-    
     // Don't let eat animation run over into next minute.
-    if (second < (59 - ((SCREEN_WIDTH + SHARK_LEFT_WIDTH) * EAT_ANIMATION_SPEED_FACTOR / 1000))) {
-      memset(&_eatState, 0, sizeof(EatStateMachine));
-      _eatState.state = EAT_INITIAL;
-      
-      sharkAnimation = getEatAnimation(data);
-      if (sharkAnimation != NULL) {
-        sharkAnimation->delay = (firstDisplay ? FIRST_DISPLAY_ANIMATION_DELAY : 0);
-      }
+    if (second >= (59 - (EAT_DISTANCE * EAT_ANIMATION_SPEED_FACTOR / 1000))) {
+      return false;
     }
-
-    return sharkAnimation;
+    
+    sharkAnimation->type = SHARK_EAT;
+    sharkAnimation->duration = EAT_DISTANCE * EAT_ANIMATION_SPEED_FACTOR;
+    sharkAnimation->delay = (firstDisplay ? FIRST_DISPLAY_ANIMATION_DELAY : 0);
+    sharkAnimation->resourceId = RESOURCE_ID_IMAGE_SHARK_EAT_STRIP;
+    sharkAnimation->startPoint = GPoint(SCREEN_WIDTH, EAT_START_Y);
+    return true;
   }
   
   if (minute < FIRST_SHARK_PASS_MINUTE) {
-    return NULL;
+    return false;
   }
   
   // Create animation every 5 minutes, if displaying for the first time, or on shake.
   if ((minute % 5 != 0) && (runNow == false)) {
-    return NULL;
+    return false;
+  }
+  
+  // Passes are only for show, so they are the first thing a saving battery drops.
+  if (DecorationsAllowed() == false) {
+    return false;
   }
   
   // Don't do animation if it would run over into the eat minute.
   if (minute == (SHARK_SCENE_EAT_MINUTE - 1) && second >= (58 - (SHARK_ANIMATION_DURATION / 1000))) {
-    return NULL;
+    return false;
   }
   
   // Don't do animation if it would run over into the next hour.
   if (minute == 59 && second >= (58 - (SHARK_ANIMATION_DURATION / 1000))) {
-    return NULL;
-  }
-  
-  SharkAnimation *sharkAnimation = malloc(sizeof(SharkAnimation));
-  if (sharkAnimation == NULL) {
-    return NULL;
+    return false;
   }
 
   bool swimRight = (minute % 2 == 0);
   
-  // Position shark PASS_OFFSET_Y below duck
-  int16_t coordinateY = WATER_TOP(minute) + ((minute > SHARK_SCENE_EAT_MINUTE) ? PASS_POST_EAT_OFFSET_Y : PASS_OFFSET_Y);
+  int16_t coordinateY = Keyframes[minute].sharkPassY;
  
   sharkAnimation->type = SHARK_PASS;
   sharkAnimation->duration = SHARK_ANIMATION_DURATION;
@@ -205,196 +242,120 @@ static SharkAnimation* getSharkAnimation(SharkLayerData *data, uint16_t minute,
   sharkAnimation->startPoint = swimRight ? (GPoint) { OFF_SCREEN_LEFT_COORD, coordinateY } : (GPoint) { SCREEN_WIDTH, coordinateY };
   sharkAnimation->endPoint = swimRight ? (GPoint) { SCREEN_WIDTH, coordinateY } : (GPoint) { OFF_SCREEN_LEFT_COORD, coordinateY };
   
-  return sharkAnimation;
+  return true;
 }
 
-static SharkAnimation* getEatAnimation(SharkLayerData *data) {
-  SharkAnimation *sharkAnimation = malloc(sizeof(SharkAnimation));
-  if (sharkAnimation == NULL) {
-    return NULL;
+// Runs the whole eat sequence from the frame scheduler. The shark swims left at a constant
+// speed and the transition table picks its height and frame as it passes each step.
+static void runEatAnimation(SharkLayerData *data, SharkAnimation *sharkAnimation) {
+  BitmapGroupSetBitmap(&data->shark, sharkAnimation->resourceId);
+  if (data->shark.bitmap == NULL) {
+    return;
   }
   
-  memset(sharkAnimation, 0, sizeof(SharkAnimation));
-  EatStateMachine newState;
-  memset(&newState, 0, sizeof(EatStateMachine));
-  
-  uint32_t resourceId = 0;
-  switch (_eatState.state) {
-    case EAT_INITIAL:
-      newState.up = (data->duckData->exited == false);
-      if (newState.up) {
-        newState.endPoint = GPoint(98, 10);
-        
-      } else {
-        // Duck has already flown away. Swim the whole width of the screen.
-        newState.endPoint = GPoint(0 - SHARK_LEFT_WIDTH, 36);
-      }
-    
-      newState.state = EAT_LEFT;
-      *sharkAnimation = (SharkAnimation) { SHARK_EAT, (SCREEN_WIDTH - newState.endPoint.x) * EAT_ANIMATION_SPEED_FACTOR, 0, 
-                                           RESOURCE_ID_IMAGE_SHARK_LEFT, { SCREEN_WIDTH, 24 }, newState.endPoint };
-    
-      break;
-    
-    case EAT_LEFT:
-      if (_eatState.up) {
-        newState.up = (data->duckData->exited == false);
-        if (newState.up) {
-          newState.endPoint = GPoint(_eatState.endPoint.x - 5, _eatState.endPoint.y - 2);
-          
-        } else {
-          newState.endPoint = GPoint(0 - SHARK_LEFT_WIDTH, 36);
-        }
-
-        resourceId = newState.up ? RESOURCE_ID_IMAGE_SHARK_OPEN_1 : RESOURCE_ID_IMAGE_SHARK_LEFT;
-        newState.state = newState.up ? EAT_OPEN_1 : EAT_LEFT;
-        *sharkAnimation = (SharkAnimation) { SHARK_EAT, (_eatState.endPoint.x - newState.endPoint.x) * EAT_ANIMATION_SPEED_FACTOR, 0, 
-                                             resourceId, _eatState.endPoint, newState.endPoint };
-        
-      } else {
-        newState.state = EAT_FINISHED;
-      }
-    
-      break;
-    
-    case EAT_OPEN_1:
-      newState.up = (data->duckData->exited == false) && _eatState.up;
-      if (newState.up) {
-        newState.endPoint = GPoint(_eatState.endPoint.x - 5, _eatState.endPoint.y - 2);
-
-      } else {
-        newState.endPoint = GPoint(0 - SHARK_LEFT_WIDTH, 36);
-      }
-    
-      resourceId = newState.up ? RESOURCE_ID_IMAGE_SHARK_OPEN_2 : RESOURCE_ID_IMAGE_SHARK_LEFT;
-      newState.state = newState.up ? EAT_OPEN_2 : EAT_LEFT;
-      *sharkAnimation = (SharkAnimation) { SHARK_EAT, (_eatState.endPoint.x - newState.endPoint.x) * EAT_ANIMATION_SPEED_FACTOR, 0, 
-                                          resourceId, _eatState.endPoint, newState.endPoint };
-        
-      break;
-    
-    case EAT_OPEN_2:
-      newState.up = (data->duckData->exited == false) && _eatState.up;
-      newState.endPoint = GPoint(_eatState.endPoint.x - 5, _eatState.endPoint.y + (newState.up ? -2 : 2));
-      resourceId = newState.up ? RESOURCE_ID_IMAGE_SHARK_OPEN_3 : RESOURCE_ID_IMAGE_SHARK_OPEN_1;
-      newState.state = newState.up ? EAT_OPEN_3 : EAT_OPEN_1;
-      *sharkAnimation = (SharkAnimation) { SHARK_EAT, (_eatState.endPoint.x - newState.endPoint.x) * EAT_ANIMATION_SPEED_FACTOR, 0, 
-                                          resourceId, _eatState.endPoint, newState.endPoint };
-        
-      break;
-    
-    case EAT_OPEN_3:
-      newState.up = (data->duckData->exited == false) && _eatState.up;
-      newState.endPoint = GPoint(_eatState.endPoint.x - 5, _eatState.endPoint.y + (newState.up ? -2 : 2));
-      resourceId = newState.up ? RESOURCE_ID_IMAGE_SHARK_OPEN_4 : RESOURCE_ID_IMAGE_SHARK_OPEN_2;
-      newState.state = newState.up ? EAT_OPEN_4 : EAT_OPEN_2;
-      *sharkAnimation = (SharkAnimation) { SHARK_EAT, (_eatState.endPoint.x - newState.endPoint.x) * EAT_ANIMATION_SPEED_FACTOR, 0, 
-                                          resourceId, _eatState.endPoint, newState.endPoint };
-        
-      break;
-    
-    case EAT_OPEN_4:
-      newState.up = (data->duckData->exited == false) && _eatState.up;
-      if (newState.up) {
-        newState.endPoint = GPoint(_eatState.endPoint.x - 13, _eatState.endPoint.y - 2);
-
-      } else {
-        newState.endPoint = GPoint(_eatState.endPoint.x - 5, _eatState.endPoint.y + 2);
-      }
-    
-      resourceId = newState.up ? RESOURCE_ID_IMAGE_SHARK_OPEN_5 : RESOURCE_ID_IMAGE_SHARK_OPEN_3;
-      newState.state = newState.up ? EAT_OPEN_5 : EAT_OPEN_3;
-      *sharkAnimation = (SharkAnimation) { SHARK_EAT, (_eatState.endPoint.x - newState.endPoint.x) * EAT_ANIMATION_SPEED_FACTOR, 0, 
-                                          resourceId, _eatState.endPoint, newState.endPoint };
-        
-      break;
-    
-    case EAT_OPEN_5:
-      newState.up = false;
-      newState.endPoint = GPoint(_eatState.endPoint.x - 5, _eatState.endPoint.y + 2);
-      resourceId = data->duckData->exited ? RESOURCE_ID_IMAGE_SHARK_OPEN_4 : RESOURCE_ID_IMAGE_SHARK_EAT_1;
-      newState.state = data->duckData->exited ? EAT_OPEN_4 : EAT_1;
-      *sharkAnimation = (SharkAnimation) { SHARK_EAT, (_eatState.endPoint.x - newState.endPoint.x) * EAT_ANIMATION_SPEED_FACTOR, 0, 
-                                          resourceId, _eatState.endPoint, newState.endPoint };
-        
-      break;
-    
-    case EAT_1:
-      newState.endPoint = GPoint(_eatState.endPoint.x - 5, _eatState.endPoint.y + 2);
-      newState.state = EAT_2;
-      *sharkAnimation = (SharkAnimation) { SHARK_EAT, (_eatState.endPoint.x - newState.endPoint.x) * EAT_ANIMATION_SPEED_FACTOR, 0, 
-                                          RESOURCE_ID_IMAGE_SHARK_EAT_2, _eatState.endPoint, newState.endPoint };
-        
-      break;
-    
-    case EAT_2:
-      newState.endPoint = GPoint(_eatState.endPoint.x - 5, _eatState.endPoint.y + 2);
-      newState.state = EAT_3;
-      *sharkAnimation = (SharkAnimation) { SHARK_EAT, (_eatState.endPoint.x - newState.endPoint.x) * EAT_ANIMATION_SPEED_FACTOR, 0, 
-                                          RESOURCE_ID_IMAGE_SHARK_EAT_3, _eatState.endPoint, newState.endPoint };
-        
-      break;
-    
-    case EAT_3:
-      newState.endPoint = GPoint(_eatState.endPoint.x - 5, _eatState.endPoint.y + 2);
-      newState.state = EAT_4;
-      *sharkAnimation = (SharkAnimation) { SHARK_EAT, (_eatState.endPoint.x - newState.endPoint.x) * EAT_ANIMATION_SPEED_FACTOR, 0, 
-                                          RESOURCE_ID_IMAGE_SHARK_EAT_4, _eatState.endPoint, newState.endPoint };
-        
-      break;
-    
-    case EAT_4:
-      newState.endPoint = GPoint(_eatState.endPoint.x - 5, _eatState.endPoint.y + 2);
-      newState.state = EAT_OPEN_2;
-      *sharkAnimation = (SharkAnimation) { SHARK_EAT, (_eatState.endPoint.x - newState.endPoint.x) * EAT_ANIMATION_SPEED_FACTOR, 0, 
-                                          RESOURCE_ID_IMAGE_SHARK_OPEN_2, _eatState.endPoint, newState.endPoint };
-        
-      break;
-    
-    default:
-      newState.state = EAT_FINISHED;
-      break;
+  GSize frameSize = GSize(data->shark.bitmap->bounds.size.w, data->shark.bitmap->bounds.size.h / EAT_FRAME_COUNT);
+  _eatFrameBitmap = gbitmap_create_as_sub_bitmap(data->shark.bitmap, (GRect) { .origin = { 0, 0 }, .size = frameSize });
+  if (_eatFrameBitmap == NULL) {
+    return;
   }
   
-  memcpy(&_eatState, &newState, sizeof(EatStateMachine));
-  if (newState.state == EAT_FINISHED && sharkAnimation != NULL) {
-    free(sharkAnimation);
-    sharkAnimation = NULL;
-  }
+  BitmapGroupShowBitmap(&data->shark, _eatFrameBitmap);
+  layer_set_frame(data->shark.layer, (GRect) { .origin = sharkAnimation->startPoint, .size = frameSize });
   
-  return sharkAnimation;
+  memset(&_eatState, 0, sizeof(EatStateMachine));
+  _eatState.state = EAT_INITIAL;
+  _eatState.startPoint = sharkAnimation->startPoint;
+  _eatState.endPoint = sharkAnimation->startPoint;
+  _eatState.up = true;
+  _eatState.elapsedMs = -(int32_t) sharkAnimation->delay;
+  _eatState.durationMs = sharkAnimation->duration;
+  _eatData = data;
+  
+  if (FrameSchedulerAdd(eatFrameCallback, data, FRAME_INTERVAL) == false) {
+    stopEatAnimation(data, true);
+  }
 }
 
-static void animationStoppedHandler(Animation *animation, bool finished, void *context) {
-  property_animation_destroy(_animation);
-  _animation = NULL;
+static bool eatFrameCallback(void *context, uint32_t elapsedMs) {
+  _eatState.elapsedMs += elapsedMs;
+  if (_eatState.elapsedMs < 0) {
+    return true;
+  }
+  
+  uint32_t progressMs = (uint32_t) _eatState.elapsedMs;
+  if (progressMs > _eatState.durationMs) {
+    progressMs = _eatState.durationMs;
+  }
+  
+  int16_t x = SCREEN_WIDTH - (int16_t) ((int32_t) EAT_DISTANCE * progressMs / _eatState.durationMs);
   
-  if (finished && _animationType == SHARK_EAT) {
-    // Work-around to crash in the Pebble animation_schedule() function in runAnimation().
-    // Schedule a timer to run the next animation.
-    _eatTimer = app_timer_register(10, (AppTimerCallback) eatTimerCallback, context);
+  // Take every step the shark has reached since the last frame.
+  while (_eatState.state != EAT_FINISHED && x <= _eatState.endPoint.x) {
+    nextEatState(_eatData);
   }
+  
+  int16_t y = _eatState.endPoint.y;
+  int16_t stepWidth = _eatState.startPoint.x - _eatState.endPoint.x;
+  if (stepWidth > 0) {
+    y = _eatState.startPoint.y + (_eatState.endPoint.y - _eatState.startPoint.y) * (_eatState.startPoint.x - x) / stepWidth;
+  }
+  
+  GRect frame = layer_get_frame(_eatData->shark.layer);
+  frame.origin = GPoint(x, y);
+  layer_set_frame(_eatData->shark.layer, frame);
+  
+  if (progressMs == _eatState.durationMs) {
+    stopEatAnimation(_eatData, true);
+    return false;
+  }
+  
+  return true;
 }
 
-static void eatTimerCallback(void *callback_data) {
-  _eatTimer = NULL;
-  SharkLayerData* data = (SharkLayerData*) callback_data;
-
-  SharkAnimation *animation = getEatAnimation(data);
+static void nextEatState(SharkLayerData *data) {
+  bool duckThere = _eatState.up && (data->duckData->exited == false);
+  const EatTransition *transition = &_eatTransitions[_eatState.state][duckThere ? 0 : 1];
   
-  if (animation == NULL) {
-    return;
+  _eatState.startPoint = _eatState.endPoint;
+  _eatState.endPoint = transition->offset;
+  if (transition->relative) {
+    _eatState.endPoint.x += _eatState.startPoint.x;
+    _eatState.endPoint.y += _eatState.startPoint.y;
   }
   
+  _eatState.state = transition->next;
+  _eatState.up = transition->up;
+  
+  // Show the frame by moving the sub-bitmap down the strip.
+  _eatFrameBitmap->bounds.origin.y = data->shark.bitmap->bounds.origin.y + transition->frame * _eatFrameBitmap->bounds.size.h;
+  layer_mark_dirty(data->shark.layer);
+  
   if (_eatState.state == EAT_1) {
     // The duck has now been eaten.
     data->duckData->exited = true;
     // The shark layer is responsible for showing/hiding the duck layer in minute SHARK_SCENE_EAT_MINUTE.
     SetLayerHidden((Layer*) data->duckData->duck.layer, &data->duckData->hidden, true);
   }
-                 
-  runAnimation(data, animation);
-  free(animation);
+}
+
+// Lets go of the strip. The shark finishes off screen facing left, so that pose is loaded
+// when the shark will be drawn again, but not when the layer is being destroyed. The frame
+// is a sub-bitmap of the strip, so it goes first.
+static void stopEatAnimation(SharkLayerData *data, bool showLeftPose) {
+  if (_eatFrameBitmap != NULL) {
+    gbitmap_destroy(_eatFrameBitmap);
+    _eatFrameBitmap = NULL;
+  }
+  
+  if (showLeftPose) {
+    BitmapGroupSetBitmap(&data->shark, RESOURCE_ID_IMAGE_SHARK_LEFT);
+  }
+  
+  _eatData = NULL;
+}
+
+static bool isAnimationInProgress(SharkLayerData *data) {
+  return (FrameAnimationIsRunning(&data->passAnimation) || _eatData != NULL);
 }
 
 static void resolveCoordinateSubstitution(GPoint *point, uint16_t objectWidth) {
@@ -4,6 +4,7 @@
   
 typedef struct {
   BitmapGroup shark;
+  FrameAnimation passAnimation;
   DuckLayerData* duckData;
   bool hidden;
   int16_t lastUpdateMinute;
@@ -0,0 +1,71 @@
+#include <pebble.h>
+#include "sprite_blit.h"
+
+static uint32_t spriteWord(const uint32_t *row, int32_t index, int32_t rowWords);
+
+// ANDs sprite into framebuffer with the sprite's top left at origin in screen
+// coordinates. Pixel x of a row is bit x % 32 of word x / 32 in both bitmaps, so a
+// sprite at any x lines up with the screen words by one shift for the whole blit. The
+// part of the sprite off the screen is clipped before any row is drawn.
+void BlitSpriteAnd(GBitmap *framebuffer, const GBitmap *sprite, GPoint origin) {
+  GRect source = sprite->bounds;
+  GSize screen = framebuffer->bounds.size;
+  
+  int16_t left = (origin.x > 0) ? origin.x : 0;
+  int16_t top = (origin.y > 0) ? origin.y : 0;
+  int16_t right = origin.x + source.size.w;
+  int16_t bottom = origin.y + source.size.h;
+  if (right > screen.w) {
+    right = screen.w;
+  }
+  
+  if (bottom > screen.h) {
+    bottom = screen.h;
+  }
+  
+  if (right <= left || bottom <= top) {
+    return;
+  }
+  
+  // Screen words the sprite covers, and the bits of the first and last of them it covers.
+  int16_t firstWord = left / 32;
+  int16_t lastWord = (right - 1) / 32;
+  uint32_t firstMask = ~(uint32_t) 0 << (left % 32);
+  uint32_t lastMask = ~(uint32_t) 0 >> (31 - ((right - 1) % 32));
+  
+  // The sprite bit that lands on the first bit of firstWord, split into a word and the
+  // shift within it. It is before the start of the row if the sprite starts mid-word.
+  int32_t sourceBit = (int32_t) firstWord * 32 - origin.x + source.origin.x;
+  int16_t shift = sourceBit & 31;
+  int32_t sourceWord = (sourceBit - shift) / 32;
+  int32_t rowWords = sprite->row_size_bytes / 4;
+  
+  for (int16_t y = top; y < bottom; y++) {
+    const uint32_t *spriteRow = (const uint32_t*) ((const uint8_t*) sprite->addr +
+                                                   (source.origin.y + y - origin.y) * sprite->row_size_bytes);
+    uint32_t *screenRow = (uint32_t*) ((uint8_t*) framebuffer->addr + y * framebuffer->row_size_bytes);
+    uint32_t low = spriteWord(spriteRow, sourceWord, rowWords);
+    
+    for (int16_t word = firstWord; word <= lastWord; word++) {
+      uint32_t high = spriteWord(spriteRow, sourceWord + (word - firstWord) + 1, rowWords);
+      uint32_t bits = (shift == 0) ? low : ((low >> shift) | (high << (32 - shift)));
+      
+      // Bits outside the sprite leave the screen as it is.
+      if (word == firstWord) {
+        bits |= ~firstMask;
+      }
+      
+      if (word == lastWord) {
+        bits |= ~lastMask;
+      }
+      
+      screenRow[word] &= bits;
+      low = high;
+    }
+  }
+}
+
+// Words before or after the row read as white, which leaves the screen as it is.
+static uint32_t spriteWord(const uint32_t *row, int32_t index, int32_t rowWords) {
+  return (index >= 0 && index < rowWords) ? row[index] : ~(uint32_t) 0;
+}
\ No newline at end of file
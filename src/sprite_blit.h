@@ -0,0 +1,9 @@
+#pragma once
+#include "common.h"
+
+// Draws 1-bit sprites straight into the captured framebuffer a 32-bit word at a time, as
+// GCompOpAnd draws them: black sprite pixels clear the screen and white ones leave it.
+// Both bitmaps need rows of whole words, which the firmware's bitmaps have, and the
+// framebuffer's bounds must start at 0, 0.
+
+void BlitSpriteAnd(GBitmap *framebuffer, const GBitmap *sprite, GPoint origin);
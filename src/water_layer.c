@@ -1,15 +1,43 @@
 #include <pebble.h>
 #include "water_layer.h"
 
-static PropertyAnimation* _animation = NULL;
+// Words in a row of the 1-bit framebuffer. Pixel x of a row is bit x % 32 of word x / 32,
+// as the framebuffer is little endian with the leftmost pixel of each byte in its lowest
+// bit.
+#define ROW_WORDS ((SCREEN_WIDTH + 31) / 32)
 
-static void animationStoppedHandler(Animation *animation, bool finished, void *context);
+// X position of the waves' left edge
+static uint16_t _wavesCoordinateX[WAVE_COUNT] = { 4, 40, 76, 112 };
+
+// Wave definition which is a group of horizontal GRects.
+static GRect _waveRows[WAVE_HEIGHT] = {
+  { {11, 0}, {6, 1} },
+  { {6, 1}, {16, 1} },
+  { {3, 2}, {22, 1} },
+  { {0, 3}, {28, 1} }
+};
+
+// Pixels to invert in each row of the waves and in a row of water, worked out once from
+// the shapes above.
+static uint32_t _waveMasks[WAVE_HEIGHT][ROW_WORDS];
+static uint32_t _waterMask[ROW_WORDS];
+
+static void waterUpdateProc(Layer *layer, GContext *ctx);
+static void riseTransitionUpdate(void *context, uint32_t progress);
+static void buildMasks();
+static void setMaskBits(uint32_t *mask, int16_t x, int16_t width);
+static GRect getLayerFrame(int16_t waterTop);
 
 WaterLayerData* CreateWaterLayer(Layer* relativeLayer, LayerRelation relation) {
   WaterLayerData* data = malloc(sizeof(WaterLayerData));
   if (data != NULL) {
-    data->inverterLayer = inverter_layer_create(GRect(0, 0, 0, 0));
-    AddLayer(relativeLayer, (Layer*) data->inverterLayer, relation);
+    memset(data, 0, sizeof(WaterLayerData));
+    buildMasks();
+    
+    // Nothing is inverted until the first draw puts the water in place.
+    data->layer = layer_create(GRect(0, 0, SCREEN_WIDTH, 0));
+    layer_set_update_proc(data->layer, waterUpdateProc);
+    AddLayer(relativeLayer, data->layer, relation);
     data->lastUpdateMinute = -1;
   }
   
@@ -25,37 +53,86 @@ void DrawWaterLayer(WaterLayerData* data, uint16_t hour, uint16_t minute) {
   // Remember whether first time called.
   bool firstDisplay = (data->lastUpdateMinute == -1); 
   data->lastUpdateMinute = minute;
-  GRect newFrame = GRect(0, WATER_TOP(minute), SCREEN_WIDTH, (SCREEN_HEIGHT - WATER_TOP(minute)));
   
-  if (minute == 0 || firstDisplay) {
-    layer_set_frame((Layer*) data->inverterLayer, newFrame);
-
-  } else if (_animation == NULL) {
-    // Create the animation and schedule it.
-    _animation = property_animation_create_layer_frame((Layer*) data->inverterLayer, NULL, &newFrame);
-    animation_set_duration((Animation*) _animation, WATER_RISE_DURATION);
-    animation_set_curve((Animation*) _animation, AnimationCurveLinear);
-    animation_set_handlers((Animation*) _animation, (AnimationHandlers) {
-      .started = NULL,
-      .stopped = (AnimationStoppedHandler) animationStoppedHandler,
-    }, NULL);
-
-    animation_schedule((Animation*) _animation);
+  // The water rises from wherever it is now, which is short of the last minute's top if
+  // an earlier rise was cut off.
+  data->riseFromTop = layer_get_frame(data->layer).origin.y + WAVE_HEIGHT;
+  data->riseToTop = WATER_TOP(minute);
+  
+  if (minute == 0 || firstDisplay || TransitionsAllowed() == false ||
+      MinuteTransitionAdd(riseTransitionUpdate, NULL, data) == NULL) {
+    layer_set_frame(data->layer, getLayerFrame(data->riseToTop));
   }
 }
 
 void DestroyWaterLayer(WaterLayerData* data) {
   if (data != NULL) {
-    if (data->inverterLayer != NULL) {
-      inverter_layer_destroy(data->inverterLayer);
-      data->inverterLayer = NULL;
+    MinuteTransitionRemove(riseTransitionUpdate, data);
+    
+    if (data->layer != NULL) {
+      layer_destroy(data->layer);
+      data->layer = NULL;
     }
     
     free(data);
   }
 }
 
-static void animationStoppedHandler(Animation *animation, bool finished, void *context) {
-  property_animation_destroy(_animation);
-  _animation = NULL;
+// Inverts the waves in the top WAVE_HEIGHT rows of the layer and the water in the rest,
+// a word at a time straight in the framebuffer. The layer is always the full width of
+// the screen.
+static void waterUpdateProc(Layer *layer, GContext *ctx) {
+  GRect frame = layer_get_frame(layer);
+  int16_t top = (frame.origin.y > 0) ? frame.origin.y : 0;
+  int16_t bottom = frame.origin.y + frame.size.h;
+  if (bottom > SCREEN_HEIGHT) {
+    bottom = SCREEN_HEIGHT;
+  }
+  
+  GBitmap *framebuffer = graphics_capture_frame_buffer(ctx);
+  if (framebuffer == NULL) {
+    return;
+  }
+  
+  for (int16_t y = top; y < bottom; y++) {
+    int16_t row = y - frame.origin.y;
+    const uint32_t *mask = (row < WAVE_HEIGHT) ? _waveMasks[row] : _waterMask;
+    uint32_t *words = (uint32_t*) ((uint8_t*) framebuffer->addr + y * framebuffer->row_size_bytes);
+    
+    for (int16_t word = 0; word < ROW_WORDS; word++) {
+      words[word] ^= mask[word];
+    }
+  }
+  
+  graphics_release_frame_buffer(ctx, framebuffer);
+}
+
+static void riseTransitionUpdate(void *context, uint32_t progress) {
+  WaterLayerData *data = (WaterLayerData*) context;
+  int16_t top = data->riseFromTop + ((data->riseToTop - data->riseFromTop) * (int32_t) progress / ANIMATION_NORMALIZED_MAX);
+  layer_set_frame(data->layer, getLayerFrame(top));
+}
+
+static void buildMasks() {
+  memset(_waveMasks, 0, sizeof(_waveMasks));
+  memset(_waterMask, 0, sizeof(_waterMask));
+  setMaskBits(_waterMask, 0, SCREEN_WIDTH);
+  
+  for (int wave = 0; wave < WAVE_COUNT; wave++) {
+    for (int waveRow = 0; waveRow < WAVE_HEIGHT; waveRow++) {
+      GRect rect = _waveRows[waveRow];
+      setMaskBits(_waveMasks[rect.origin.y], _wavesCoordinateX[wave] + rect.origin.x, rect.size.w);
+    }
+  }
+}
+
+static void setMaskBits(uint32_t *mask, int16_t x, int16_t width) {
+  for (int16_t bit = x; bit < x + width && bit < SCREEN_WIDTH; bit++) {
+    mask[bit / 32] |= ((uint32_t) 1 << (bit % 32));
+  }
+}
+
+// The layer starts WAVE_HEIGHT rows above the water and runs to the bottom of the screen.
+static GRect getLayerFrame(int16_t waterTop) {
+  return GRect(0, waterTop - WAVE_HEIGHT, SCREEN_WIDTH, (SCREEN_HEIGHT - waterTop) + WAVE_HEIGHT);
 }
\ No newline at end of file
@@ -1,8 +1,12 @@
 #pragma once
 #include "common.h"
   
+// The water and the waves riding on it, drawn by inverting the framebuffer. The layer
+// covers the waves and the water below them, and rises on the minute transition.
 typedef struct {
-  InverterLayer* inverterLayer;
+  Layer* layer;
+  int16_t riseFromTop;    // Water top the rise started from
+  int16_t riseToTop;      // Water top the rise ends at
   int16_t lastUpdateMinute;
 } WaterLayerData;
 
@@ -0,0 +1,138 @@
+#!/usr/bin/env python
+#
+# Generates keyframes.auto.c, the per-minute positions of the duck, water, shark and
+# Santa, so the layers look them up instead of working them out every minute.
+#
+# Usage: gen_keyframes.py <common.h> <source out>
+#
+# The screen size, wave height and scene minutes are read from common.h so both stay
+# in step. The tables are checked before they are written, and the build fails if a
+# position would be off screen or out of order.
+#
+
+import re
+import sys
+
+MINUTES = 60
+
+# Duck x coordinates along the wave. The duck moves right along these for minutes 0-14
+# and 30-44, and back left for minutes 15-29 and 45-59.
+DUCK_COORDINATE_X = [17, 25, 32, 40, 48, 56, 63, 71, 79, 86, 94, 102, 110, 117, 125]
+
+# Pixels to offset the duck in the positive Y direction to make the duck look like
+# it is comfortably sitting on the wave.
+WAVE_OFFSET_Y = [1, 1, 4, 3, 1, 1, 2, 4, 2, 1, 1, 3, 4, 2, 1]
+
+# The water rises 14 pixels every 5 minutes.
+WATER_RISE = (14, 5)
+
+# Have the shark pass under the duck by SHARK_PASS_OFFSET_Y, and above where the duck
+# was once it has been eaten.
+SHARK_PASS_OFFSET_Y = 15
+SHARK_PASS_POST_EAT_OFFSET_Y = -7
+
+# Santa's fly-by starts between these y coordinates, lower early in the hour.
+SANTA_TOP_PASS_Y = 24
+SANTA_BOTTOM_PASS_Y = 76
+
+
+def read_defines(path):
+    defines = {}
+    with open(path) as source:
+        for match in re.finditer(r'^#define\s+(\w+)\s+(-?\d+)\s*$', source.read(), re.MULTILINE):
+            defines[match.group(1)] = int(match.group(2))
+
+    return defines
+
+
+def c_divide(numerator, denominator):
+    # C division truncates towards zero.
+    quotient = abs(numerator) // abs(denominator)
+    return quotient if (numerator < 0) == (denominator < 0) else -quotient
+
+
+def build_keyframes(defines):
+    positions = len(DUCK_COORDINATE_X)
+    keyframes = []
+    for minute in range(MINUTES):
+        moving_right = minute < positions or (positions * 2 <= minute < positions * 3)
+        position = minute % positions
+        if not moving_right:
+            position = positions - position - 1
+
+        water_top = defines['SCREEN_HEIGHT'] - c_divide(minute * WATER_RISE[0], WATER_RISE[1])
+        duck_y = water_top - defines['WAVE_HEIGHT'] + WAVE_OFFSET_Y[position]
+
+        shark_offset = SHARK_PASS_POST_EAT_OFFSET_Y if minute > defines['SHARK_SCENE_EAT_MINUTE'] else SHARK_PASS_OFFSET_Y
+        santa_minute = min(minute, defines['LAST_SANTA_ANIMATION_MINUTE'])
+        santa_y = SANTA_BOTTOM_PASS_Y - c_divide((SANTA_BOTTOM_PASS_Y - SANTA_TOP_PASS_Y) * santa_minute,
+                                                 defines['LAST_SANTA_ANIMATION_MINUTE'])
+
+        keyframes.append({
+            'duck_x': DUCK_COORDINATE_X[position],
+            'duck_y': duck_y,
+            'moving_right': moving_right,
+            'water_top': water_top,
+            'shark_y': water_top + shark_offset,
+            'santa_y': santa_y,
+        })
+
+    return keyframes
+
+
+def check_keyframes(keyframes, defines):
+    errors = []
+    previous = None
+    for minute, keyframe in enumerate(keyframes):
+        if not 0 <= keyframe['duck_x'] < defines['SCREEN_WIDTH']:
+            errors.append('minute %d: duck x %d is off screen' % (minute, keyframe['duck_x']))
+        if not 0 < keyframe['water_top'] <= defines['SCREEN_HEIGHT']:
+            errors.append('minute %d: water top %d is off screen' % (minute, keyframe['water_top']))
+        if not keyframe['water_top'] - defines['WAVE_HEIGHT'] < keyframe['duck_y'] <= keyframe['water_top']:
+            errors.append('minute %d: duck y %d is not on the wave' % (minute, keyframe['duck_y']))
+        if not SANTA_TOP_PASS_Y <= keyframe['santa_y'] <= SANTA_BOTTOM_PASS_Y:
+            errors.append('minute %d: santa y %d is outside the fly zone' % (minute, keyframe['santa_y']))
+
+        if previous is not None:
+            if keyframe['water_top'] > previous['water_top']:
+                errors.append('minute %d: water falls' % minute)
+            if abs(keyframe['duck_x'] - previous['duck_x']) > 8:
+                errors.append('minute %d: duck jumps from x %d to %d' % (minute, previous['duck_x'], keyframe['duck_x']))
+
+        previous = keyframe
+
+    return errors
+
+
+def write_source(keyframes, path):
+    with open(path, 'w') as out:
+        out.write('// Generated by tools/gen_keyframes.py. Do not edit.\n\n')
+        out.write('#include <pebble.h>\n')
+        out.write('#include "common.h"\n\n')
+        out.write('const Keyframe Keyframes[KEYFRAME_COUNT] = {\n')
+        for minute, keyframe in enumerate(keyframes):
+            out.write('  { { %d, %d }, %s, %d, %d, %d },  // %02d\n' %
+                      (keyframe['duck_x'], keyframe['duck_y'], 'true' if keyframe['moving_right'] else 'false',
+                       keyframe['water_top'], keyframe['shark_y'], keyframe['santa_y'], minute))
+        out.write('};\n')
+
+
+def main(argv):
+    if len(argv) != 3:
+        sys.stderr.write('usage: %s <common.h> <source out>\n' % argv[0])
+        return 1
+
+    defines = read_defines(argv[1])
+    keyframes = build_keyframes(defines)
+    errors = check_keyframes(keyframes, defines)
+    if errors:
+        for error in errors:
+            sys.stderr.write('%s\n' % error)
+        return 1
+
+    write_source(keyframes, argv[2])
+    return 0
+
+
+if __name__ == '__main__':
+    sys.exit(main(sys.argv))
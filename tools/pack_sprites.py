@@ -0,0 +1,190 @@
+#!/usr/bin/env python
+#
+# Packs the PNG image resources into Pebble's raw 1-bit bitmap format and generates
+# sprite_metrics.auto.h, the size, hypotenuse and bottom-center anchor of each image, so
+# the code reads them from the images instead of keeping copies in sync by hand.
+#
+# Usage: pack_sprites.py <appinfo.json> <resources dir> <header out>
+#
+# host/gen_resources.py uses pack_image() to embed the images already packed, the way
+# the SDK stores them on the watch, so the host build does not decode PNGs either.
+#
+
+import json
+import math
+import os
+import struct
+import sys
+import zlib
+
+PNG_SIGNATURE = b'\x89PNG\r\n\x1a\n'
+
+# Bitmap format version stored in the top bits of the info flags.
+BITMAP_VERSION = 1 << 12
+
+
+def load_images(appinfo_path):
+    with open(appinfo_path) as appinfo:
+        media = json.load(appinfo)['resources']['media']
+
+    return [entry for entry in media if entry['type'] == 'png']
+
+
+def paeth(a, b, c):
+    estimate = a + b - c
+    distance_a = abs(estimate - a)
+    distance_b = abs(estimate - b)
+    distance_c = abs(estimate - c)
+    if distance_a <= distance_b and distance_a <= distance_c:
+        return a
+    return b if distance_b <= distance_c else c
+
+
+def luminance(red, green, blue):
+    return (red * 299 + green * 587 + blue * 114) // 1000
+
+
+def decode_png(path):
+    """Returns (width, height, rows) with a row of booleans, True for white, per line.
+    Pixels at least half bright are white, and transparent pixels are white like the
+    background."""
+    with open(path, 'rb') as image:
+        data = image.read()
+
+    if not data.startswith(PNG_SIGNATURE):
+        raise ValueError('%s is not a PNG' % path)
+
+    offset = len(PNG_SIGNATURE)
+    compressed = b''
+    palette = []
+    while offset + 12 <= len(data):
+        length, chunk_type = struct.unpack('>I4s', data[offset:offset + 8])
+        chunk = data[offset + 8:offset + 8 + length]
+        if chunk_type == b'IHDR':
+            width, height, bit_depth, color_type, _, _, interlace = struct.unpack('>IIBBBBB', chunk)
+        elif chunk_type == b'PLTE':
+            palette = [tuple(bytearray(chunk[index:index + 3])) for index in range(0, length - 2, 3)]
+        elif chunk_type == b'IDAT':
+            compressed += chunk
+        elif chunk_type == b'IEND':
+            break
+        offset += 12 + length
+
+    channels = {0: 1, 2: 3, 3: 1, 4: 2, 6: 4}.get(color_type)
+    if channels is None or interlace != 0:
+        raise ValueError('%s: unsupported PNG color type %d or interlacing' % (path, color_type))
+
+    bits_per_pixel = channels * bit_depth
+    stride = (width * bits_per_pixel + 7) // 8
+    filter_bytes = (bits_per_pixel + 7) // 8
+    raw = bytearray(zlib.decompress(compressed))
+
+    rows = []
+    previous = bytearray(stride)
+    for y in range(height):
+        start = y * (stride + 1)
+        line_filter = raw[start]
+        line = raw[start + 1:start + 1 + stride]
+        for index in range(stride):
+            a = line[index - filter_bytes] if index >= filter_bytes else 0
+            b = previous[index]
+            c = previous[index - filter_bytes] if index >= filter_bytes else 0
+            if line_filter == 1:
+                line[index] = (line[index] + a) & 0xff
+            elif line_filter == 2:
+                line[index] = (line[index] + b) & 0xff
+            elif line_filter == 3:
+                line[index] = (line[index] + (a + b) // 2) & 0xff
+            elif line_filter == 4:
+                line[index] = (line[index] + paeth(a, b, c)) & 0xff
+        previous = line
+
+        row = []
+        sample_bytes = max(bit_depth // 8, 1)
+        for x in range(width):
+            alpha = 255
+            if bit_depth < 8:
+                bit_offset = x * bit_depth
+                sample = (line[bit_offset // 8] >> (8 - bit_depth - bit_offset % 8)) & ((1 << bit_depth) - 1)
+                if color_type == 3:
+                    bright = luminance(*palette[sample]) if sample < len(palette) else luminance(*palette[0])
+                else:
+                    bright = sample * 255 // ((1 << bit_depth) - 1)
+            else:
+                # Only the most significant byte of 16 bit samples matters.
+                pixel = line[x * channels * sample_bytes:(x + 1) * channels * sample_bytes][::sample_bytes]
+                if color_type == 0:
+                    bright = pixel[0]
+                elif color_type == 2:
+                    bright = luminance(pixel[0], pixel[1], pixel[2])
+                elif color_type == 3:
+                    bright = luminance(*palette[pixel[0]])
+                elif color_type == 4:
+                    bright, alpha = pixel[0], pixel[1]
+                else:
+                    bright, alpha = luminance(pixel[0], pixel[1], pixel[2]), pixel[3]
+
+            row.append(alpha < 128 or bright >= 128)
+        rows.append(row)
+
+    return width, height, rows
+
+
+def row_size_bytes(width):
+    # Rows are padded to whole 32-bit words.
+    return ((width + 31) // 32) * 4
+
+
+def pack_image(path):
+    """Returns the image as a raw bitmap: the row size, info flags and bounds followed by
+    the rows, least significant bit leftmost and set bits white."""
+    width, height, rows = decode_png(path)
+    row_size = row_size_bytes(width)
+    packed = bytearray(struct.pack('<HHhhhh', row_size, BITMAP_VERSION, 0, 0, width, height))
+    for row in rows:
+        line = bytearray(row_size)
+        for x, white in enumerate(row):
+            if white:
+                line[x // 8] |= 1 << (x % 8)
+        packed += line
+
+    return bytes(packed)
+
+
+def write_header(images, resources_dir, path):
+    with open(path, 'w') as out:
+        out.write('#pragma once\n\n')
+        out.write('// Generated by tools/pack_sprites.py. Do not edit.\n\n')
+        out.write('// Size, hypotenuse and bottom-center anchor of every image resource. The hypotenuse\n')
+        out.write('// is the side of the square the image fits in at any angle.\n')
+
+        metrics = []
+        for entry in images:
+            width, height, _ = decode_png(os.path.join(resources_dir, entry['file']))
+            hypotenuse = int(math.sqrt(width * width + height * height))
+            metrics.append((entry['name'], width, height, hypotenuse))
+
+            out.write('\n')
+            out.write('#define %s_WIDTH %d\n' % (entry['name'], width))
+            out.write('#define %s_HEIGHT %d\n' % (entry['name'], height))
+            out.write('#define %s_HYPOTENUSE %d\n' % (entry['name'], hypotenuse))
+            out.write('#define %s_ANCHOR GPoint(%d, %d)\n' % (entry['name'], width // 2, height))
+
+        out.write('\n// SPRITE_METRICS(SPRITE) calls SPRITE(name, width, height, hypotenuse) for every image.\n')
+        out.write('#define SPRITE_METRICS(SPRITE) \\\n')
+        for name, width, height, hypotenuse in metrics:
+            out.write('  SPRITE(%s, %d, %d, %d) \\\n' % (name, width, height, hypotenuse))
+        out.write('\n')
+
+
+def main(argv):
+    if len(argv) != 4:
+        sys.stderr.write('usage: %s <appinfo.json> <resources dir> <header out>\n' % argv[0])
+        return 1
+
+    write_header(load_images(argv[1]), argv[2], argv[3])
+    return 0
+
+
+if __name__ == '__main__':
+    sys.exit(main(sys.argv))